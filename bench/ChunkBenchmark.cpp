@@ -0,0 +1,246 @@
+// Headless benchmark of terrain generation and meshing (ChunkMesher), no GL or window needed.
+//
+//   ChunkBenchmark [--chunks N] [--sizes 16,32] [--seeds 1666154,42] [--json out.json]
+//
+// Every seed/size pair generates and meshes N chunks laid out in a square like World does.
+// A summary goes to stdout, --json writes the same numbers for comparing builds.
+// Built with TRACK_ALLOCATIONS=1 it also reports heap allocations per chunk.
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+#include "ChunkMesher.h"
+#include "AllocTracker.h"
+
+struct BenchmarkRun
+{
+    unsigned int seed;
+    int chunkSize;
+    int chunks;
+    double generateSeconds = 0.0;
+    double meshSeconds = 0.0;
+    double vertices = 0.0;      // floats / 8, solid mesh
+    double indices = 0.0;
+    double waterVertices = 0.0;
+    double billboards = 0.0;
+    AllocCounters generateAllocs;
+    AllocCounters meshAllocs;
+};
+
+static void AddDelta(AllocCounters& sum, const AllocCounters& before, const AllocCounters& after)
+{
+    sum.allocations += after.allocations - before.allocations;
+    sum.bytes += after.bytes - before.bytes;
+}
+
+// Peak resident set size of the process in KiB
+static long PeakMemoryKB()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return static_cast<long>(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss; // KiB on Linux
+#endif
+}
+
+// Comma separated unsigned 32-bit values; false on anything else
+static bool ParseList(const char* text, std::vector<unsigned int>& values)
+{
+    values.clear();
+    for (const char* p = text; ; )
+    {
+        char* end = nullptr;
+        errno = 0;
+        unsigned long long value = std::strtoull(p, &end, 10);
+        // strtoull takes a sign and wraps negative numbers, so digits have to come first
+        if (*p < '0' || *p > '9' || errno == ERANGE || value > UINT_MAX || (*end != ',' && *end != '\0'))
+            return false;
+        values.push_back(static_cast<unsigned int>(value));
+        if (*end == '\0')
+            return true;
+        p = end + 1;
+    }
+}
+
+// Chunks per second as text; fallback when the clock measured no time at all
+static std::string FormatRate(const BenchmarkRun& run, const char* format, const char* fallback)
+{
+    double seconds = run.generateSeconds + run.meshSeconds;
+    if (!(seconds > 0.0))
+        return fallback;
+    char text[32];
+    std::snprintf(text, sizeof(text), format, run.chunks / seconds);
+    return text;
+}
+
+static BenchmarkRun Run(unsigned int seed, int chunkSize, int chunks)
+{
+    typedef std::chrono::steady_clock Clock;
+    BenchmarkRun run;
+    run.seed = seed;
+    run.chunkSize = chunkSize;
+    run.chunks = chunks;
+
+    // Plants are placed with rand(); seeding it makes every run place the same ones
+    std::srand(seed);
+    // Untimed warm-up: builds the static noise tables for this seed
+    {
+        ChunkMesher warmup(chunkSize, glm::vec3(0.0f));
+        warmup.Generate(seed);
+        warmup.Mesh();
+    }
+
+    int side = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(chunks))));
+    for (int i = 0; i < chunks; i++)
+    {
+        glm::vec3 origin((i % side) * chunkSize, 0.0f, (i / side) * chunkSize);
+        AllocCounters generateBefore = AllocTracker::GetTotal(AllocTag::ChunkGenerate);
+        AllocCounters meshBefore = AllocTracker::GetTotal(AllocTag::ChunkMesh);
+        Clock::time_point start, generated, meshed;
+        {
+            AllocScope allocScope(AllocTag::ChunkGenerate);
+            ChunkMesher mesher(chunkSize, origin);
+            start = Clock::now();
+            mesher.Generate(seed);
+            generated = Clock::now();
+            AllocTracker::SetCurrentTag(AllocTag::ChunkMesh);
+            mesher.Mesh();
+            meshed = Clock::now();
+
+            run.vertices += mesher.GetVertices().size() / 8;
+            run.indices += mesher.GetIndices().size();
+            run.waterVertices += mesher.GetWaterVertices().size() / 8;
+            run.billboards += mesher.GetBillBoardInstances().size() / 5;
+        }
+        AddDelta(run.generateAllocs, generateBefore, AllocTracker::GetTotal(AllocTag::ChunkGenerate));
+        AddDelta(run.meshAllocs, meshBefore, AllocTracker::GetTotal(AllocTag::ChunkMesh));
+
+        run.generateSeconds += std::chrono::duration<double>(generated - start).count();
+        run.meshSeconds += std::chrono::duration<double>(meshed - generated).count();
+    }
+    return run;
+}
+
+int main(int argc, char** argv)
+{
+    int chunks = 64;
+    std::vector<unsigned int> sizes{ 32 };
+    std::vector<unsigned int> seeds{ 1666154 };
+    const char* jsonPath = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--chunks") && hasValue)
+            chunks = std::max(std::atoi(argv[++i]), 1);
+        else if (!std::strcmp(argv[i], "--sizes") && hasValue && ParseList(argv[i + 1], sizes))
+            i++;
+        else if (!std::strcmp(argv[i], "--seeds") && hasValue && ParseList(argv[i + 1], seeds))
+            i++;
+        else if (!std::strcmp(argv[i], "--json") && hasValue)
+            jsonPath = argv[++i];
+        else
+        {
+            std::fprintf(stderr, "usage: %s [--chunks N] [--sizes 16,32] [--seeds 1666154,42] [--json out.json]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::vector<BenchmarkRun> runs;
+    for (unsigned int seed : seeds)
+    {
+        for (unsigned int size : sizes)
+        {
+            if (size == 0 || size > CHUNK_MAX_SIZE)
+            {
+                std::fprintf(stderr, "skipping size %u, chunk sizes are 1..%d\n", size, CHUNK_MAX_SIZE);
+                continue;
+            }
+            runs.push_back(Run(seed, static_cast<int>(size), chunks));
+        }
+    }
+    long peakKB = PeakMemoryKB();
+
+    std::printf("%10s %5s %7s %12s %14s %14s %12s %12s\n",
+        "seed", "size", "chunks", "chunks/s", "gen ns/voxel", "mesh ns/voxel", "verts/chunk", "idx/chunk");
+    for (const BenchmarkRun& run : runs)
+    {
+        double voxels = double(run.chunkSize) * run.chunkSize * run.chunkSize * run.chunks;
+        std::printf("%10u %5d %7d %12s %14.2f %14.2f %12.0f %12.0f\n",
+            run.seed, run.chunkSize, run.chunks, FormatRate(run, "%.1f", "n/a").c_str(),
+            run.generateSeconds * 1e9 / voxels, run.meshSeconds * 1e9 / voxels,
+            run.vertices / run.chunks, run.indices / run.chunks);
+    }
+    if (AllocTracker::IsEnabled())
+    {
+        std::printf("%10s %5s %14s %14s %14s %14s\n", "seed", "size", "gen allocs", "gen KiB", "mesh allocs", "mesh KiB");
+        for (const BenchmarkRun& run : runs)
+        {
+            std::printf("%10u %5d %14.1f %14.1f %14.1f %14.1f\n", run.seed, run.chunkSize,
+                double(run.generateAllocs.allocations) / run.chunks, run.generateAllocs.bytes / 1024.0 / run.chunks,
+                double(run.meshAllocs.allocations) / run.chunks, run.meshAllocs.bytes / 1024.0 / run.chunks);
+        }
+        std::printf("(per chunk)\n");
+    }
+    std::printf("peak memory: %ld KiB\n", peakKB);
+
+    if (jsonPath)
+    {
+        FILE* file = std::fopen(jsonPath, "w");
+        if (!file)
+        {
+            std::fprintf(stderr, "cannot write %s\n", jsonPath);
+            return 1;
+        }
+        std::fprintf(file, "{\n  \"benchmark\": \"chunk\",\n  \"peak_memory_kb\": %ld,\n  \"runs\": [\n", peakKB);
+        for (size_t i = 0; i < runs.size(); i++)
+        {
+            const BenchmarkRun& run = runs[i];
+            double voxels = double(run.chunkSize) * run.chunkSize * run.chunkSize * run.chunks;
+            std::fprintf(file,
+                "    { \"seed\": %u, \"chunk_size\": %d, \"chunks\": %d, "
+                "\"generate_seconds\": %.6f, \"mesh_seconds\": %.6f, \"chunks_per_second\": %s, "
+                "\"generate_ns_per_voxel\": %.3f, \"mesh_ns_per_voxel\": %.3f, "
+                "\"vertices_per_chunk\": %.1f, \"indices_per_chunk\": %.1f, "
+                "\"water_vertices_per_chunk\": %.1f, \"billboards_per_chunk\": %.1f",
+                run.seed, run.chunkSize, run.chunks,
+                run.generateSeconds, run.meshSeconds, FormatRate(run, "%.3f", "null").c_str(),
+                run.generateSeconds * 1e9 / voxels, run.meshSeconds * 1e9 / voxels,
+                run.vertices / run.chunks, run.indices / run.chunks,
+                run.waterVertices / run.chunks, run.billboards / run.chunks);
+            if (AllocTracker::IsEnabled())
+            {
+                std::fprintf(file,
+                    ", \"generate_allocs_per_chunk\": %.1f, \"generate_bytes_per_chunk\": %.1f, "
+                    "\"mesh_allocs_per_chunk\": %.1f, \"mesh_bytes_per_chunk\": %.1f",
+                    double(run.generateAllocs.allocations) / run.chunks, double(run.generateAllocs.bytes) / run.chunks,
+                    double(run.meshAllocs.allocations) / run.chunks, double(run.meshAllocs.bytes) / run.chunks);
+            }
+            std::fprintf(file, " }%s\n", i + 1 < runs.size() ? "," : "");
+        }
+        std::fprintf(file, "  ]\n}\n");
+        std::fclose(file);
+    }
+    return 0;
+}
@@ -5,24 +5,24 @@
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 layout(location = 2) in vec2 texCoord;
+// Per instance: block position and atlas coordinate of the plant type
+layout(location = 3) in vec3 instancePos;
+layout(location = 4) in vec2 instanceTexCoord;
 
-uniform mat4 u_Model;
-uniform mat4 u_View;
-uniform mat4 u_Proj;
-uniform mat4 u_LightPV;
+#include "PerFrame.glsl"
 
 out vec2 v_TexCoord;
 out vec3 v_Normal;
 out vec3 v_FragPos;
-out vec4 v_PositionFromLight;
+invariant gl_Position; // depth pre-pass (Shadow.shader)
 
 void main()
 {
-    v_FragPos = (u_Model * vec4(position, 1.0)).xyz;
+    vec3 worldPos = position + instancePos;
+    v_FragPos = (u_Model * vec4(worldPos, 1.0)).xyz;
     v_Normal =  (u_Model * vec4(normal, 0.0)).xyz;
-    gl_Position = u_Proj * u_View * u_Model * vec4(position.xyz, 1);
-    v_TexCoord = texCoord;
-    v_PositionFromLight = u_LightPV * u_Model * vec4(position, 1.0);
+    gl_Position = u_Proj * u_View * u_Model * vec4(worldPos, 1);
+    v_TexCoord = texCoord + instanceTexCoord;
 };
 
 
@@ -34,25 +34,23 @@ in vec3 v_Normal;
 in vec3 v_FragPos;
 
 layout (location = 0) out vec4 FragColor;
-layout (location = 1) out vec4 BrightColor;
 
 uniform sampler2D u_Texture;
-uniform vec3 u_LightPos;
-uniform float u_LightIntensity;
-uniform vec3 u_CameraPos;
-uniform float u_Kd;
-uniform float u_Ks;
-
-// Settings
-uniform int show_Shadow;
-uniform int show_PCF;
-uniform int show_PCSS;
-
-// Shadow Map Related
-in vec4 v_PositionFromLight;
+#include "PerFrame.glsl"
+
+// Static lighting constants from MaterialUniforms (UniformBuffer.h)
+layout(std140) uniform Material
+{
+    float u_LightIntensity;
+    float u_Kd;
+    float u_Ks;
+};
+
+// Shadow Map Related (USE_SHADOW, USE_PCF, USE_PCSS, USE_VSM variants)
 uniform sampler2D u_ShadowMap;
+uniform sampler2D u_MomentsMap;
 
-#define NUM_SAMPLES 50
+#define NUM_SAMPLES SHADOW_FILTER_SAMPLES // injected from Renderer.h
 #define BLOCKER_SEARCH_NUM_SAMPLES NUM_SAMPLES
 #define PCF_NUM_SAMPLES NUM_SAMPLES
 #define NUM_RINGS 10
@@ -94,6 +92,24 @@ void poissonDiskSamples( const in vec2 randomSeed ) {
     }
 }
 
+// Cascaded shadow map: a 2x2 atlas with one tile per cascade, nearest cascade first
+#define CASCADE_MARGIN 0.95 // keep filter taps inside the tile
+
+bool cascadeShadowCoord(vec3 worldPos, out vec3 coord)
+{
+    for(int i = 0; i < SHADOW_CASCADES; i++)
+    {
+        vec4 lightPos = u_LightPV[i] * vec4(worldPos, 1.0);
+        if(all(lessThan(abs(lightPos.xy), vec2(CASCADE_MARGIN))))
+        {
+            coord = (lightPos.xyz + 1.0) * 0.5; // NDC coord
+            coord.xy = (coord.xy + vec2(i % 2, i / 2)) * 0.5; // tile of the atlas
+            return true;
+        }
+    }
+    return false;
+}
+
 float useShadowMap(sampler2D shadowMap, vec4 shadowCoord)
 {
     float shadowMapDepth = texture2D(shadowMap, shadowCoord.xy).x;
@@ -170,6 +186,23 @@ float PCSS(sampler2D shadowMap, vec4 coords){
     return visibility;
 }
 
+// Variance shadow map: one filtered fetch of pre-blurred depth moments
+#define VSM_MIN_VARIANCE 0.00002
+#define VSM_BLEED_REDUCTION 0.3
+
+float VSM(sampler2D momentsMap, vec4 coords)
+{
+    vec2 moments = texture(momentsMap, coords.xy).rg;
+    float depth = coords.z;
+    if(depth <= moments.x + BIAS)
+        return 1.0;
+    // Chebyshev upper bound of the lit fraction, remapped against light bleeding
+    float variance = max(moments.y - moments.x * moments.x, VSM_MIN_VARIANCE);
+    float d = depth - moments.x;
+    float pMax = variance / (variance + d * d);
+    return clamp((pMax - VSM_BLEED_REDUCTION) / (1.0 - VSM_BLEED_REDUCTION), 0.0, 1.0);
+}
+
 void main()
 {
     if(texture2D(u_Texture, v_TexCoord).a == 0) //Transparent part
@@ -193,29 +226,22 @@ void main()
     vec3 specular = u_Ks * light_atten_coff * spec * vec3(1.0, 1.0, 1.0);  
 
     float visibility = 1.0;
-    if(bool(show_Shadow))
+#ifdef USE_SHADOW
+    // visibility, beyond the last cascade everything is lit
+    vec3 shadowCoord;
+    if(cascadeShadowCoord(v_FragPos, shadowCoord))
     {
-        // visibility
-        vec3 shadowCoord = v_PositionFromLight.xyz / v_PositionFromLight.w;
-        shadowCoord = (shadowCoord + 1.0) * 0.5; // NDC coord
-        if(bool(show_PCF))
-        {
-            visibility = PCF(u_ShadowMap, vec4(shadowCoord, 1.0));
-        }
-        else if(bool(show_PCSS))
-        {
-            visibility = PCSS(u_ShadowMap, vec4(shadowCoord, 1.0));
-        }
-        else{
-            visibility = useShadowMap(u_ShadowMap, vec4(shadowCoord, 1.0));
-        }
+#if defined(USE_PCF)
+        visibility = PCF(u_ShadowMap, vec4(shadowCoord, 1.0));
+#elif defined(USE_PCSS)
+        visibility = PCSS(u_ShadowMap, vec4(shadowCoord, 1.0));
+#elif defined(USE_VSM)
+        visibility = VSM(u_MomentsMap, vec4(shadowCoord, 1.0));
+#else
+        visibility = useShadowMap(u_ShadowMap, vec4(shadowCoord, 1.0));
+#endif
     }
+#endif
 
     FragColor = vec4(ambient + visibility * (diffuse + specular), 1.0);
-
-    BrightColor = vec4(0.0, 0.0, 0.0, 1.0);
-    // Check whether fragment output is higher than threshold, if so output as brightness color
-    float brightness = dot(FragColor.rgb, vec3(0.2126, 0.7152, 0.0722));
-    if(brightness > 1.0)
-        BrightColor = vec4(FragColor.rgb, 1.0);
 };
\ No newline at end of file
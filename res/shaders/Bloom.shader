@@ -0,0 +1,77 @@
+
+#shader vertex
+#version 330 core
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+void main()
+{
+    gl_Position = vec4(position.xy, 0, 1);
+    v_TexCoord = texCoord;
+};
+
+
+#shader fragment
+#version 330 core
+
+out vec4 FragColor;
+in vec2 v_TexCoord;
+
+uniform sampler2D image;
+uniform int upsample;
+uniform int brightPass; // first downsample, straight from the scene colour
+
+// Only what is brighter than 1.0 blooms
+vec3 tap(vec2 uv)
+{
+    vec3 color = texture(image, uv).rgb;
+    if(bool(brightPass) && dot(color, vec3(0.2126, 0.7152, 0.0722)) <= 1.0)
+        return vec3(0.0);
+    return color;
+}
+
+void main()
+{
+    vec2 texel = 1.0 / textureSize(image, 0); // gets size of single texel of the source level
+    vec2 uv = v_TexCoord;
+    vec3 result;
+    if(bool(upsample))
+    {
+        // 3x3 tent filter, added onto the larger level by blending
+        result  = texture(image, uv).rgb * 4.0;
+        result += texture(image, uv + vec2(-texel.x, 0.0)).rgb * 2.0;
+        result += texture(image, uv + vec2( texel.x, 0.0)).rgb * 2.0;
+        result += texture(image, uv + vec2(0.0, -texel.y)).rgb * 2.0;
+        result += texture(image, uv + vec2(0.0,  texel.y)).rgb * 2.0;
+        result += texture(image, uv + vec2(-texel.x, -texel.y)).rgb;
+        result += texture(image, uv + vec2( texel.x, -texel.y)).rgb;
+        result += texture(image, uv + vec2(-texel.x,  texel.y)).rgb;
+        result += texture(image, uv + vec2( texel.x,  texel.y)).rgb;
+        result /= 16.0;
+    }
+    else
+    {
+        // 13 bilinear taps: overlapping 4x4 boxes, keeps small bright spots from flickering
+        vec3 a = tap(uv + texel * vec2(-2.0,  2.0));
+        vec3 b = tap(uv + texel * vec2( 0.0,  2.0));
+        vec3 c = tap(uv + texel * vec2( 2.0,  2.0));
+        vec3 d = tap(uv + texel * vec2(-2.0,  0.0));
+        vec3 e = tap(uv);
+        vec3 f = tap(uv + texel * vec2( 2.0,  0.0));
+        vec3 g = tap(uv + texel * vec2(-2.0, -2.0));
+        vec3 h = tap(uv + texel * vec2( 0.0, -2.0));
+        vec3 i = tap(uv + texel * vec2( 2.0, -2.0));
+        vec3 j = tap(uv + texel * vec2(-1.0,  1.0));
+        vec3 k = tap(uv + texel * vec2( 1.0,  1.0));
+        vec3 l = tap(uv + texel * vec2(-1.0, -1.0));
+        vec3 m = tap(uv + texel * vec2( 1.0, -1.0));
+        result  = e * 0.125;
+        result += (a + c + g + i) * 0.03125;
+        result += (b + d + f + h) * 0.0625;
+        result += (j + k + l + m) * 0.125;
+    }
+    FragColor = vec4(result, 1.0);
+}
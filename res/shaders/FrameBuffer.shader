@@ -22,7 +22,6 @@ in vec2 v_TexCoord;
 uniform sampler2D screenTexture;
 uniform sampler2D brightTexture;
 uniform sampler2D depthTexture;
-uniform int underwater;
 
 const vec3 waterColor = vec3(0.1, 0.3, 0.6);
 const vec3 fogColor = vec3(1.0, 1.0, 1.0);
@@ -34,14 +33,11 @@ uniform float brightness;
 uniform float contrast;
 uniform float gamma;
 uniform float saturation;
-uniform int foggy;
-uniform int bloom;
-uniform int reinhard;
-uniform int ce;
-uniform int filmic;
-uniform int aces;
 uniform float exposure;
 
+// Effects are compile-time variants: USE_BLOOM, UNDERWATER, USE_FOG,
+// TONEMAP_REINHARD, TONEMAP_CE, TONEMAP_FILMIC, TONEMAP_ACES
+
 vec3 rgb2hsv(vec3 c)
 {
     vec4 K = vec4(0.0, -1.0 / 3.0, 2.0 / 3.0, -1.0);
@@ -104,39 +100,40 @@ void main()
     color = (color - 0.5) * contrast + 0.5 + brightness;
 
     // Bloom
-    if(bool(bloom))
-    {
-        vec3 blurredColor = texture(brightTexture, v_TexCoord).rgb;
-        color = color + 0.5 * blurredColor;
-    }
+#ifdef USE_BLOOM
+    // Mip 0 of the bloom chain holds the sum of BLOOM_MIPS levels (injected from FrameBuffer.h)
+    vec3 blurredColor = texture(brightTexture, v_TexCoord).rgb / float(BLOOM_MIPS);
+    color = color + 0.5 * blurredColor;
+#endif
 
     // Screen Space Fog
     vec3 finalColor = vec3(0.0);
-    if (bool(underwater))
-	{
-		float fogFactor = clamp((depth - waterNear) / (fogFar - waterNear),0.0, 1.0);
-		fogFactor = pow(fogFactor, 3.0);
-		finalColor = mix(color, waterColor, fogFactor);
-	}
-    else if (bool(foggy)){
-        float fogFactor = clamp((depth - fogNear) / (fogFar - fogNear), 0.0, 1.0);
-		fogFactor = pow(fogFactor, 2.0);
-		finalColor = mix(color, fogColor, fogFactor);
-    }
-    else{
-        finalColor = color;
-    }
+#if defined(UNDERWATER)
+    float fogFactor = clamp((depth - waterNear) / (fogFar - waterNear),0.0, 1.0);
+    fogFactor = pow(fogFactor, 3.0);
+    finalColor = mix(color, waterColor, fogFactor);
+#elif defined(USE_FOG)
+    float fogFactor = clamp((depth - fogNear) / (fogFar - fogNear), 0.0, 1.0);
+    fogFactor = pow(fogFactor, 2.0);
+    finalColor = mix(color, fogColor, fogFactor);
+#else
+    finalColor = color;
+#endif
 
     // Tone Mapping
     vec3 mapped = finalColor;
-    if(bool(reinhard))
-        mapped = mapped * exposure / (1.0 + mapped * exposure);
-    if(bool(ce))
-        mapped = vec3(1.0) - exp(-finalColor * exposure);
-    if(bool(filmic))
-        mapped = Uncharted2ToneMapping(finalColor, exposure);
-    if(bool(aces))
-        mapped = ACESToneMapping(finalColor, exposure);
+#ifdef TONEMAP_REINHARD
+    mapped = mapped * exposure / (1.0 + mapped * exposure);
+#endif
+#ifdef TONEMAP_CE
+    mapped = vec3(1.0) - exp(-finalColor * exposure);
+#endif
+#ifdef TONEMAP_FILMIC
+    mapped = Uncharted2ToneMapping(finalColor, exposure);
+#endif
+#ifdef TONEMAP_ACES
+    mapped = ACESToneMapping(finalColor, exposure);
+#endif
 
     // Gamma Correction
     finalColor = pow(mapped, vec3(1.0 / gamma));
@@ -0,0 +1,12 @@
+// Filled once per frame from PerFrameUniforms (UniformBuffer.h); pulled in with #include by every stage using it
+layout(std140) uniform PerFrame
+{
+    mat4 u_Model;
+    mat4 u_View;
+    mat4 u_Proj;
+    mat4 u_LightPV[SHADOW_CASCADES];
+    vec3 u_CameraPos;
+    float u_Time;
+    vec3 u_LightPos;
+    int waterGeometry;
+};
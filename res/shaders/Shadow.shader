@@ -4,16 +4,30 @@
 
 layout(location = 0) in vec3 position;
 layout(location = 2) in vec2 texCoord;
+// Billboard instances only; disabled arrays read the default (0, 0, 0, 1)
+layout(location = 3) in vec3 instancePos;
+layout(location = 4) in vec2 instanceTexCoord;
 
-uniform mat4 u_Model;
-uniform mat4 u_LightPV;
+#include "PerFrame.glsl"
+uniform int u_Cascade;
 
 out vec2 v_TexCoord;
 
+// DEPTH_PREPASS: camera depth only, for the lighting pass to test with GL_EQUAL.
+// Must compute gl_Position exactly like Basic.shader and BillBoard.shader.
+#ifdef DEPTH_PREPASS
+invariant gl_Position;
+#endif
+
 void main()
 {
-    gl_Position = u_LightPV * u_Model * vec4(position.xyz, 1);
-    v_TexCoord = texCoord;
+#ifdef DEPTH_PREPASS
+    vec3 worldPos = position + instancePos;
+    gl_Position = u_Proj * u_View * u_Model * vec4(worldPos, 1);
+#else
+    gl_Position = u_LightPV[u_Cascade] * u_Model * vec4(position.xyz + instancePos, 1);
+#endif
+    v_TexCoord = texCoord + instanceTexCoord;
 };
 
 
@@ -23,9 +37,17 @@ void main()
 in vec2 v_TexCoord;
 uniform sampler2D u_Texture;
 
+layout (location = 0) out vec4 Moments; // only stored while VSM is on
+
 void main()
 {
     if(texture2D(u_Texture, v_TexCoord).a == 0)
         discard;
-    gl_FragColor = vec4(gl_FragCoord.zzz, 1.0);
+#ifndef DEPTH_PREPASS
+    // The derivative term accounts for depth variation across the texel
+    float depth = gl_FragCoord.z;
+    float dx = dFdx(depth);
+    float dy = dFdy(depth);
+    Moments = vec4(depth, depth * depth + 0.25 * (dx * dx + dy * dy), 0.0, 1.0);
+#endif
 };
\ No newline at end of file
@@ -6,10 +6,7 @@ layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 normal;
 layout(location = 2) in vec2 texCoord;
 
-uniform mat4 u_Model;
-uniform mat4 u_View;
-uniform mat4 u_Proj;
-uniform float time;
+#include "PerFrame.glsl"
 
 out VS_OUT {
     vec2 v_TexCoord;
@@ -37,7 +34,7 @@ void main()
         float wavelength = waveParams[i].y;
         float direction = waveParams[i].z;
         float k = 2.0 * 3.14159 / wavelength;
-        float parse = k * (position.x * cos(direction) + position.z * sin(direction)) + time;
+        float parse = k * (position.x * cos(direction) + position.z * sin(direction)) + u_Time;
         height += amplitude * cos(parse);
         horizonal -= amplitude * sin(parse);
         maxAmplitude += amplitude;
@@ -50,8 +47,8 @@ void main()
 
     // Texture Coords (4 water textures)
     vs_out.v_TexCoord = texCoord;
-    vs_out.v_TexCoord.x += floor(mod(time / animationTime, 2)) * 1.0f / 64.0f;
-	vs_out.v_TexCoord.y += floor(mod(time / animationTime * 2, 2)) * 1.0f / 32.0f;
+    vs_out.v_TexCoord.x += floor(mod(u_Time / animationTime, 2)) * 1.0f / 64.0f;
+	vs_out.v_TexCoord.y += floor(mod(u_Time / animationTime * 2, 2)) * 1.0f / 32.0f;
 };
 
 
@@ -67,7 +64,7 @@ in VS_OUT {
     vec3 v_FragPos;
 } gs_in[];
 
-uniform int waterGeometry;
+#include "PerFrame.glsl"
 
 out vec2 v_TexCoord;
 out vec3 v_Normal;
@@ -105,14 +102,17 @@ in vec3 v_Normal;
 in vec3 v_FragPos;
 
 layout (location = 0) out vec4 FragColor;
-layout (location = 1) out vec4 BrightColor;
 
 uniform sampler2D u_Texture;
-uniform vec3 u_LightPos;
-uniform float u_LightIntensity;
-uniform vec3 u_CameraPos;
-uniform float u_Kd;
-uniform float u_Ks;
+#include "PerFrame.glsl"
+
+// Static lighting constants from MaterialUniforms (UniformBuffer.h)
+layout(std140) uniform Material
+{
+    float u_LightIntensity;
+    float u_Kd;
+    float u_Ks;
+};
 
 void main()
 {
@@ -137,10 +137,4 @@ void main()
     vec3 specular = u_Ks * light_atten_coff * spec * vec3(1.0, 1.0, 1.0);  
 
     FragColor = vec4(ambient + diffuse + specular, 0.9);
-
-    BrightColor = vec4(0.0, 0.0, 0.0, 1.0);
-    // Check whether fragment output is higher than threshold, if so output as brightness color
-    float brightness = dot(FragColor.rgb, vec3(0.2126, 0.7152, 0.0722));
-    if(brightness > 1.0)
-        BrightColor = vec4(FragColor.rgb, 1.0);
 };
\ No newline at end of file
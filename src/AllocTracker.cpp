@@ -0,0 +1,127 @@
+#include "AllocTracker.h"
+
+#include <cstdlib>
+#include <new>
+
+static const int TagCount = int(AllocTag::UNDIFINED);
+
+// Running totals; a frame is the difference between two snapshots
+static std::atomic<unsigned long long> s_Allocations[TagCount];
+static std::atomic<unsigned long long> s_Bytes[TagCount];
+static AllocCounters s_FrameStart[TagCount];
+static AllocCounters s_LastFrame[TagCount];
+
+// Plain int so reading it never allocates
+static thread_local int s_CurrentTag = int(AllocTag::Other);
+
+void AllocTracker::Record(size_t bytes)
+{
+    s_Allocations[s_CurrentTag].fetch_add(1, std::memory_order_relaxed);
+    s_Bytes[s_CurrentTag].fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void AllocTracker::BeginFrame()
+{
+    for (int tag = 0; tag < TagCount; tag++)
+    {
+        AllocCounters now = GetTotal(AllocTag(tag));
+        s_LastFrame[tag].allocations = now.allocations - s_FrameStart[tag].allocations;
+        s_LastFrame[tag].bytes = now.bytes - s_FrameStart[tag].bytes;
+        s_FrameStart[tag] = now;
+    }
+}
+
+AllocCounters AllocTracker::GetFrame(AllocTag tag)
+{
+    return s_LastFrame[int(tag)];
+}
+
+AllocCounters AllocTracker::GetTotal(AllocTag tag)
+{
+    AllocCounters counters;
+    counters.allocations = s_Allocations[int(tag)].load(std::memory_order_relaxed);
+    counters.bytes = s_Bytes[int(tag)].load(std::memory_order_relaxed);
+    return counters;
+}
+
+const char* AllocTracker::GetTagName(AllocTag tag)
+{
+    switch (tag)
+    {
+    case AllocTag::Other:         return "Other";
+    case AllocTag::World:         return "World";
+    case AllocTag::ChunkGenerate: return "Chunk Generate";
+    case AllocTag::ChunkMesh:     return "Chunk Mesh";
+    case AllocTag::ChunkUpload:   return "Chunk Upload";
+    case AllocTag::Render:        return "Render";
+    case AllocTag::ImGui:         return "ImGui";
+    default:                      return "?";
+    }
+}
+
+AllocTag AllocTracker::GetCurrentTag()
+{
+    return AllocTag(s_CurrentTag);
+}
+
+void AllocTracker::SetCurrentTag(AllocTag tag)
+{
+    s_CurrentTag = int(tag);
+}
+
+#if TRACK_ALLOCATIONS
+// Global replacements; every other form of new/delete forwards to these
+void* operator new(size_t size)
+{
+    AllocTracker::Record(size);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    AllocTracker::Record(size);
+    return std::malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept
+{
+    std::free(p);
+}
+#endif
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+// Allocation tracking replaces the global operator new/delete, so it is opt-in:
+// build with TRACK_ALLOCATIONS=1 to count. Scopes and queries compile either way.
+#ifndef TRACK_ALLOCATIONS
+#define TRACK_ALLOCATIONS 0
+#endif
+
+// Subsystem an allocation is charged to, set per thread by AllocScope
+enum class AllocTag {
+	Other, World, ChunkGenerate, ChunkMesh, ChunkUpload, Render, ImGui,
+	UNDIFINED
+};
+
+struct AllocCounters
+{
+	unsigned long long allocations = 0;
+	unsigned long long bytes = 0;
+};
+
+// Counts operator new calls and requested bytes per AllocTag, in total and per frame.
+class AllocTracker
+{
+public:
+	static bool IsEnabled() { return TRACK_ALLOCATIONS != 0; }
+
+	// Close the previous frame; its counts are then available from GetFrame()
+	static void BeginFrame();
+	static AllocCounters GetFrame(AllocTag tag);
+	static AllocCounters GetTotal(AllocTag tag);
+	static const char* GetTagName(AllocTag tag);
+
+	static AllocTag GetCurrentTag();
+	static void SetCurrentTag(AllocTag tag);
+
+	// Called by the operator new replacement
+	static void Record(size_t bytes);
+};
+
+// Charges the allocations of the enclosing block on this thread to tag
+class AllocScope
+{
+public:
+	AllocScope(AllocTag tag) : m_Previous(AllocTracker::GetCurrentTag()) { AllocTracker::SetCurrentTag(tag); }
+	~AllocScope() { AllocTracker::SetCurrentTag(m_Previous); }
+
+private:
+	AllocTag m_Previous;
+};
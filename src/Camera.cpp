@@ -5,7 +5,8 @@
 #include <glm/gtx/quaternion.hpp>
 
 Camera::Camera(float verticalFOV, float nearClip, float farClip, GLFWwindow* window)
-	: m_VerticalFOV(verticalFOV), m_NearClip(nearClip), m_FarClip(farClip), m_Window(window)
+	: m_VerticalFOV(verticalFOV), m_NearClip(nearClip), m_FarClip(farClip),
+	m_Input(std::make_shared<GlfwCameraInput>(window))
 {
 	m_ForwardDirection = glm::vec3(1, 0, 0);
 	m_Position = glm::vec3(-4, 0, 0);
@@ -14,20 +15,22 @@ Camera::Camera(float verticalFOV, float nearClip, float farClip, GLFWwindow* win
 
 bool Camera::OnUpdate(float ts)
 {
-	double xpos, ypos;
-	glfwGetCursorPos(m_Window, &xpos, &ypos);
-	glm::vec2 mousePos{ float(xpos), float(ypos) };
+	if (!m_Input)
+		return false;
+
+	CameraInputState input = m_Input->Poll();
+	glm::vec2 mousePos = input.mousePosition;
 	
 	glm::vec2 delta = (mousePos - m_LastMousePosition) * 0.002f;
 	m_LastMousePosition = mousePos;
 
-	if (!(glfwGetMouseButton(m_Window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS))
+	if (!input.look)
 	{
-		glfwSetInputMode(m_Window, GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+		m_Input->SetCursorCaptured(false);
 		return false;
 	}
 
-	glfwSetInputMode(m_Window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+	m_Input->SetCursorCaptured(true);
 
 	bool moved = false;
 
@@ -37,32 +40,32 @@ bool Camera::OnUpdate(float ts)
 	float speed = 5.0f;
 
 	// Movement
-	if (glfwGetKey(m_Window, GLFW_KEY_W) == GLFW_PRESS)
+	if (input.forward)
 	{
 		m_Position += m_ForwardDirection * speed * ts;
 		moved = true;
 	}
-	else if (glfwGetKey(m_Window, GLFW_KEY_S) == GLFW_PRESS)
+	else if (input.back)
 	{
 		m_Position -= m_ForwardDirection * speed * ts;
 		moved = true;
 	}
-	if (glfwGetKey(m_Window, GLFW_KEY_A) == GLFW_PRESS)
+	if (input.left)
 	{
 		m_Position -= rightDirection * speed * ts;
 		moved = true;
 	}
-	else if (glfwGetKey(m_Window, GLFW_KEY_D) == GLFW_PRESS)
+	else if (input.right)
 	{
 		m_Position += rightDirection * speed * ts;
 		moved = true;
 	}
-	if (glfwGetKey(m_Window, GLFW_KEY_Q) == GLFW_PRESS)
+	if (input.down)
 	{
 		m_Position -= upDirection * speed * ts;
 		moved = true;
 	}
-	else if (glfwGetKey(m_Window, GLFW_KEY_E) == GLFW_PRESS)
+	else if (input.up)
 	{
 		m_Position += upDirection * speed * ts;
 		moved = true;
@@ -106,6 +109,13 @@ void Camera::SetPosition(glm::vec3 pos)
 	RecalculateView();
 }
 
+void Camera::SetPose(glm::vec3 pos, glm::vec3 direction)
+{
+	m_Position = pos;
+	m_ForwardDirection = glm::normalize(direction);
+	RecalculateView();
+}
+
 float Camera::GetRotationSpeed()
 {
 	return 0.3f;
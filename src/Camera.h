@@ -3,15 +3,23 @@
 #include <GLFW/glfw3.h>
 #include <glm/glm.hpp>
 #include <vector>
+#include <memory>
+
+#include "CameraInput.h"
 
 class Camera
 {
 public:
+	// Reads the keyboard and mouse of window until SetInput() replaces the source
 	Camera(float verticalFOV, float nearClip, float farClip, GLFWwindow* window);
 
 	bool OnUpdate(float ts);
 	void OnResize(uint32_t width, uint32_t height);
 	void SetPosition(glm::vec3 pos);
+	// Place the camera directly, e.g. from a recorded path
+	void SetPose(glm::vec3 pos, glm::vec3 direction);
+	// nullptr: OnUpdate() leaves the camera alone
+	void SetInput(std::shared_ptr<CameraInput> input) { m_Input = input; }
 
 	const glm::mat4& GetProjection() const { return m_Projection; }
 	const glm::mat4& GetInverseProjection() const { return m_InverseProjection; }
@@ -43,5 +51,5 @@ private:
 
 	uint32_t m_ViewportWidth = 0, m_ViewportHeight = 0;
 
-	GLFWwindow* m_Window;
+	std::shared_ptr<CameraInput> m_Input;
 };
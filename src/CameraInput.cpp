@@ -0,0 +1,28 @@
+#include "CameraInput.h"
+
+GlfwCameraInput::GlfwCameraInput(GLFWwindow* window)
+    : m_Window(window)
+{
+}
+
+CameraInputState GlfwCameraInput::Poll()
+{
+    CameraInputState state;
+    double xpos, ypos;
+    glfwGetCursorPos(m_Window, &xpos, &ypos);
+    state.mousePosition = glm::vec2(float(xpos), float(ypos));
+
+    state.look = glfwGetMouseButton(m_Window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS;
+    state.forward = glfwGetKey(m_Window, GLFW_KEY_W) == GLFW_PRESS;
+    state.back = glfwGetKey(m_Window, GLFW_KEY_S) == GLFW_PRESS;
+    state.left = glfwGetKey(m_Window, GLFW_KEY_A) == GLFW_PRESS;
+    state.right = glfwGetKey(m_Window, GLFW_KEY_D) == GLFW_PRESS;
+    state.down = glfwGetKey(m_Window, GLFW_KEY_Q) == GLFW_PRESS;
+    state.up = glfwGetKey(m_Window, GLFW_KEY_E) == GLFW_PRESS;
+    return state;
+}
+
+void GlfwCameraInput::SetCursorCaptured(bool captured)
+{
+    glfwSetInputMode(m_Window, GLFW_CURSOR, captured ? GLFW_CURSOR_DISABLED : GLFW_CURSOR_NORMAL);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+
+// What the camera reads each frame, independent of where it comes from
+struct CameraInputState
+{
+	glm::vec2 mousePosition{ 0.0f, 0.0f };
+	bool look = false; // mouse look and movement only while held
+	bool forward = false, back = false;
+	bool left = false, right = false;
+	bool down = false, up = false;
+};
+
+// Source of camera input. Camera only talks to this, so runs can be driven by
+// something other than the live keyboard and mouse.
+class CameraInput
+{
+public:
+	virtual ~CameraInput() = default;
+
+	virtual CameraInputState Poll() = 0;
+	// Hide and lock the cursor while looking around
+	virtual void SetCursorCaptured(bool) {}
+};
+
+// Keyboard and mouse of a GLFW window (right mouse button + WASDQE)
+class GlfwCameraInput : public CameraInput
+{
+public:
+	GlfwCameraInput(GLFWwindow* window);
+
+	CameraInputState Poll() override;
+	void SetCursorCaptured(bool captured) override;
+
+private:
+	GLFWwindow* m_Window;
+};
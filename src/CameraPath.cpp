@@ -0,0 +1,92 @@
+#include "CameraPath.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+void CameraPath::Record(float time, const glm::vec3& position, const glm::vec3& direction)
+{
+    CameraPose pose;
+    pose.time = time;
+    pose.position = position;
+    pose.direction = direction;
+    m_Poses.push_back(pose);
+}
+
+bool CameraPath::Save(const std::string& filepath) const
+{
+    std::ofstream stream(filepath);
+    if (!stream)
+    {
+        std::cout << "Failed to write camera path " << filepath << std::endl;
+        return false;
+    }
+    // Enough digits that replay reproduces the recorded view exactly
+    stream.precision(9);
+    for (const CameraPose& pose : m_Poses)
+    {
+        stream << pose.time << ' '
+            << pose.position.x << ' ' << pose.position.y << ' ' << pose.position.z << ' '
+            << pose.direction.x << ' ' << pose.direction.y << ' ' << pose.direction.z << '\n';
+    }
+    return true;
+}
+
+bool CameraPath::Load(const std::string& filepath)
+{
+    std::ifstream stream(filepath);
+    if (!stream)
+    {
+        std::cout << "Failed to read camera path " << filepath << std::endl;
+        return false;
+    }
+
+    m_Poses.clear();
+    std::string line;
+    while (getline(stream, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        CameraPose pose;
+        if (!(fields >> pose.time
+            >> pose.position.x >> pose.position.y >> pose.position.z
+            >> pose.direction.x >> pose.direction.y >> pose.direction.z))
+        {
+            std::cout << "Malformed camera path line in " << filepath << ": " << line << std::endl;
+            m_Poses.clear();
+            return false;
+        }
+        if (!m_Poses.empty() && pose.time < m_Poses.back().time)
+            pose.time = m_Poses.back().time;
+        m_Poses.push_back(pose);
+    }
+    return !m_Poses.empty();
+}
+
+CameraPose CameraPath::Sample(float time) const
+{
+    if (m_Poses.empty())
+        return CameraPose();
+    if (time <= m_Poses.front().time)
+        return m_Poses.front();
+    if (time >= m_Poses.back().time)
+        return m_Poses.back();
+
+    // First pose after time; the one before it is the start of the segment
+    auto next = std::upper_bound(m_Poses.begin(), m_Poses.end(), time,
+        [](float t, const CameraPose& pose) { return t < pose.time; });
+    const CameraPose& a = *(next - 1);
+    const CameraPose& b = *next;
+
+    float span = b.time - a.time;
+    float t = span > 0.0f ? (time - a.time) / span : 1.0f;
+    CameraPose pose;
+    pose.time = time;
+    pose.position = glm::mix(a.position, b.position, t);
+    pose.direction = glm::mix(a.direction, b.direction, t);
+    if (glm::length(pose.direction) < 1e-4f)
+        pose.direction = b.direction;
+    return pose;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Camera pose at a point in time (seconds since the recording started)
+struct CameraPose
+{
+	float time = 0.0f;
+	glm::vec3 position{ 0.0f };
+	glm::vec3 direction{ 1.0f, 0.0f, 0.0f };
+};
+
+// A recorded camera flight. Recording stores one pose per rendered frame; replaying
+// samples it at fixed time steps, so the same frames are rendered on every run
+// no matter how long each frame took.
+// File format: one "time px py pz dx dy dz" line per pose.
+class CameraPath
+{
+public:
+	void Clear() { m_Poses.clear(); }
+	// Times must not decrease
+	void Record(float time, const glm::vec3& position, const glm::vec3& direction);
+
+	bool Save(const std::string& filepath) const;
+	bool Load(const std::string& filepath);
+
+	// Pose at time, interpolated between the recorded ones and clamped to the ends
+	CameraPose Sample(float time) const;
+
+	bool IsEmpty() const { return m_Poses.empty(); }
+	float GetDuration() const { return m_Poses.empty() ? 0.0f : m_Poses.back().time; }
+	size_t GetPoseCount() const { return m_Poses.size(); }
+
+private:
+	std::vector<CameraPose> m_Poses;
+};
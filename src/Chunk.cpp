@@ -1,435 +1,88 @@
 #include "Chunk.h"
+#include "Trace.h"
+#include "AllocTracker.h"
 #include <glm/gtc/matrix_transform.hpp>
-#include "vendor/OpenSimplexNoise.hh"
+
+std::weak_ptr<VertexBuffer> Chunk::m_CrossQuadVB;
+std::weak_ptr<IndexBuffer> Chunk::m_CrossQuadIB;
 
 Chunk::Chunk(int chunkSize, glm::vec3 originPos)
+    : m_Mesher(chunkSize, originPos), m_OriginPos(originPos)
 {
-	m_ChunkSize = chunkSize + 2; // һȦŻɣ
-	data.resize(m_ChunkSize * m_ChunkSize * m_ChunkSize);
-    LoadBlockTextures();
-    m_OriginPos = originPos;
-
-    m_NoiseSettings.resize(2);
-    m_NoiseSettings[0] = { 20.0f,0.01f,0.0f };
-    m_NoiseSettings[1] = { 3.0f,0.05f,0.0f };
 }
 
 Chunk::~Chunk()
 {
     std::cout << "Deleted chunk at pos(" << m_OriginPos.x << ", " << m_OriginPos.y << ", " << m_OriginPos.z << ")" << std::endl;
 }
-// ʵʵindex(0-based)ȡdataиλõķ
-int Chunk::GetBlockTypeID(glm::ivec3 index)
-{
-	/*      y
-            |
-            O -- x
-           /
-          z
-	*/
-    int type = data[index.x + 1 + (index.y + 1) * m_ChunkSize + (index.z + 1) * m_ChunkSize * m_ChunkSize];
-	return type;
-}
 
-void Chunk::LoadBlockTextures()
+void Chunk::Generate(unsigned int seed, std::vector<std::shared_ptr<Shader>> shader)
 {
-    constexpr int BlockTypeCount = static_cast<int>(BlockType::UNDIFINED);
-    m_BlockTypes.resize(BlockTypeCount);
-    for (int i = 0; i < BlockTypeCount; i++)
     {
-        switch (i)
-        {
-        case (int)BlockType::Grass:
-            m_BlockTypes[i].left   = glm::vec2(25.0f / 64.0f, 23.0f / 32.0f);
-            m_BlockTypes[i].right  = glm::vec2(25.0f / 64.0f, 23.0f / 32.0f);
-            m_BlockTypes[i].top    = glm::vec2(11.0f / 64.0f, 14.0f / 32.0f);
-            m_BlockTypes[i].bottom = glm::vec2(21.0f / 64.0f, 18.0f / 32.0f);
-            m_BlockTypes[i].front  = glm::vec2(25.0f / 64.0f, 23.0f / 32.0f);
-            m_BlockTypes[i].back   = glm::vec2(25.0f / 64.0f, 23.0f / 32.0f);
-            break;
-        case (int)BlockType::Dirt:
-            m_BlockTypes[i].left   = glm::vec2(21.0f / 64.0f, 18.0f / 32.0f);
-            m_BlockTypes[i].right  = glm::vec2(21.0f / 64.0f, 18.0f / 32.0f);
-            m_BlockTypes[i].top    = glm::vec2(21.0f / 64.0f, 18.0f / 32.0f);
-            m_BlockTypes[i].bottom = glm::vec2(21.0f / 64.0f, 18.0f / 32.0f);
-            m_BlockTypes[i].front  = glm::vec2(21.0f / 64.0f, 18.0f / 32.0f);
-            m_BlockTypes[i].back   = glm::vec2(21.0f / 64.0f, 18.0f / 32.0f);
-            break;
-        case (int)BlockType::Stone:
-            m_BlockTypes[i].left   = glm::vec2(6.0f / 64.0f, 5.0f / 32.0f);
-            m_BlockTypes[i].right  = glm::vec2(6.0f / 64.0f, 5.0f / 32.0f);
-            m_BlockTypes[i].top    = glm::vec2(6.0f / 64.0f, 5.0f / 32.0f);
-            m_BlockTypes[i].bottom = glm::vec2(6.0f / 64.0f, 5.0f / 32.0f);
-            m_BlockTypes[i].front  = glm::vec2(6.0f / 64.0f, 5.0f / 32.0f);
-            m_BlockTypes[i].back   = glm::vec2(6.0f / 64.0f, 5.0f / 32.0f);
-            break;
-        case (int)BlockType::Kusa:
-            m_BlockTypes[i].front = glm::vec2(10.0f / 64.0f, 7.0f / 32.0f);
-            m_BlockTypes[i].back =  glm::vec2(10.0f / 64.0f, 7.0f / 32.0f);
-            break;
-        case (int)BlockType::Daisy:
-            m_BlockTypes[i].front = glm::vec2(29.0f / 64.0f, 13.0f / 32.0f);
-            m_BlockTypes[i].back =  glm::vec2(29.0f / 64.0f, 13.0f / 32.0f);
-            break;
-        case (int)BlockType::Tulip:
-            m_BlockTypes[i].front = glm::vec2(17.0f / 64.0f, 12.0f / 32.0f);
-            m_BlockTypes[i].back =  glm::vec2(17.0f / 64.0f, 12.0f / 32.0f);
-            break;
-        case (int)BlockType::Dandelion:
-            m_BlockTypes[i].front = glm::vec2(18.0f / 64.0f, 28.0f / 32.0f);
-            m_BlockTypes[i].back =  glm::vec2(18.0f / 64.0f, 28.0f / 32.0f);
-            break;
-        case (int)BlockType::Poppy:
-            m_BlockTypes[i].front = glm::vec2(21.0f / 64.0f, 11.0f / 32.0f);
-            m_BlockTypes[i].back =  glm::vec2(21.0f / 64.0f, 11.0f / 32.0f);
-            break;
-        case (int)BlockType::Water:
-            m_BlockTypes[i].left   = glm::vec2(63.0f / 64.0f, 0.0f / 32.0f);
-            m_BlockTypes[i].right  = glm::vec2(63.0f / 64.0f, 0.0f / 32.0f);
-            m_BlockTypes[i].top    = glm::vec2(6.0f  / 64.0f, 28.0f / 32.0f);
-            m_BlockTypes[i].bottom = glm::vec2(63.0f / 64.0f, 0.0f / 32.0f);
-            m_BlockTypes[i].front  = glm::vec2(63.0f / 64.0f, 0.0f / 32.0f);
-            m_BlockTypes[i].back   = glm::vec2(63.0f / 64.0f, 0.0f / 32.0f);
-            break;
-        default:
-            break;
-        }
-    }
-}
-
-void Chunk::Generate(unsigned int seed)
-{
-	// NOTE: y value is the UP axis
-
-    static OSN::Noise<2> noise2D(seed);
-    static int waterLevel = 18;
-    //OSN::Noise<3> noise3D(seed);
-
-    // Generating Step
-	int height = 0;
-	for (int z = 0; z < m_ChunkSize; z++)
-	{
-		for (int x = 0; x < m_ChunkSize; x++)
-		{
-            float noiseValue2D = 0.0f;
-            float normalizeNum = 0.0f;
-            for (int i = 0; i < m_NoiseSettings.size(); i++)
-            {
-                noiseValue2D += noise2D.eval(
-                    (float)((x - 1 + m_OriginPos.x) * m_NoiseSettings[i].frequency) + m_NoiseSettings[i].offset,
-                    (float)((z - 1 + m_OriginPos.z) * m_NoiseSettings[i].frequency) + m_NoiseSettings[i].offset)
-                    * m_NoiseSettings[i].amplitude;
-                normalizeNum += m_NoiseSettings[i].amplitude;
-            }
-            noiseValue2D = (noiseValue2D + normalizeNum) / 2 / normalizeNum;
-            height = (int)(pow(noiseValue2D, 1) * m_ChunkSize);
-            
-            // block data
-            for (int y = 0; y < height / 2; y++)
-                data[x + y * m_ChunkSize + z * m_ChunkSize * m_ChunkSize] = (int)BlockType::Stone;
-			for (int y = height / 2; y < height - 1; y++)
-				data[x + y * m_ChunkSize + z * m_ChunkSize * m_ChunkSize] = (int)BlockType::Dirt;
-            // The top is Grass Block
-            if (height > 0)
-                data[x + (height - 1) * m_ChunkSize + z * m_ChunkSize * m_ChunkSize] = (int)BlockType::Grass;
-            // Water
-            if (height < waterLevel)
-            {
-                for (int y = height; y < waterLevel; y++)
-                    data[x + y * m_ChunkSize + z * m_ChunkSize * m_ChunkSize] = (int)BlockType::Water;
-                continue; // no need to generate flowers etc.
-            }
-            // Random Kusa
-            if (rand() % 20 == 0 && height != 0 && height <= m_ChunkSize)
-                data[x + height * m_ChunkSize + z * m_ChunkSize * m_ChunkSize] = (int)BlockType::Kusa;
-            // Random Flower
-            if (rand() % 50 == 0 && height != 0 && height <= m_ChunkSize)
-            {
-                int flowerTypeNum = (int)BlockType::Grass - (int)BlockType::Daisy;
-                data[x + height * m_ChunkSize + z * m_ChunkSize * m_ChunkSize] = (int)BlockType::Kusa + rand() % flowerTypeNum;
-            }
-		}
-	}
-
-	m_Vertices.clear();
-	m_Indices.clear();
-
-	// Rendering Optimize : BATCH RENDERING
-	for (int z = 0; z < m_ChunkSize - 2; z++)
-	{
-		for (int x = 0; x < m_ChunkSize - 2; x++)
-		{
-			for (int y = 0; y < m_ChunkSize - 2; y++)
-			{
-                int blockTypeID = GetBlockTypeID(glm::ivec3(x, y, z));
-                if (blockTypeID == (int)BlockType::Air)
-                    continue;
-
-				// ǰλ
-				glm::vec3 position(x, y, z);
-                position += m_OriginPos; //offset
-
-                if (blockTypeID >= (int)BlockType::Grass) //Block
-                {
-                    // 
-                    // 棨ʱҪ
-                    /*if (y == 0 || GetBlockTypeID(glm::ivec3(x, y - 1, z)) < (int)BlockType::Grass) {
-                        // ӵĸ
-                        float textureCoordX = m_BlockTypes[blockTypeID].bottom.x;
-                        float textureCoordY = m_BlockTypes[blockTypeID].bottom.y;
-                        m_Vertices.insert(m_Vertices.end(), {
-                            position.x + 1.0f, position.y, position.z,  // 
-                            0.0f, -1.0f, 0.0f,                           // 
-                            textureCoordX + 1.0f / 64.0f, textureCoordY, // 
-
-                            position.x, position.y, position.z,  // 
-                            0.0f, -1.0f, 0.0f,                     // 
-                            textureCoordX, textureCoordY,         // 
-
-                            position.x, position.y, position.z + 1.0f,  // 
-                            0.0f, -1.0f, 0.0f,                           // 
-                            textureCoordX, textureCoordY + 1.0f / 32.0f,  // 
-
-                            position.x + 1.0f, position.y, position.z + 1.0f,  // 
-                            0.0f, -1.0f, 0.0f,                               // 
-                            textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f // 
-                            });
-                    }*/
-
-                    // 
-                    if (GetBlockTypeID(glm::ivec3(x, y + 1, z)) < (int)BlockType::Grass) {
-                        // Ӷĸ
-                        float textureCoordX = m_BlockTypes[blockTypeID].top.x;
-                        float textureCoordY = m_BlockTypes[blockTypeID].top.y;
-                        m_Vertices.insert(m_Vertices.end(), {
-                            position.x, position.y + 1.0f, position.z,  // 
-                            0.0f, 1.0f, 0.0f,                       // 
-                            textureCoordX, textureCoordY,          // 
-
-                            position.x + 1.0f, position.y + 1.0f, position.z,  // 
-                            0.0f, 1.0f, 0.0f,                               // 
-                            textureCoordX + 1.0f / 64.0f, textureCoordY, // 
-
-                            position.x + 1.0f, position.y + 1.0f, position.z + 1.0f,  // 
-                            0.0f, 1.0f, 0.0f,                                       // 
-                            textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f, // 
-
-                            position.x, position.y + 1.0f, position.z + 1.0f,  // 
-                            0.0f, 1.0f, 0.0f,                                   // 
-                            textureCoordX, textureCoordY + 1.0f / 32.0f // 
-                            });
-                    }
-
-                    // ڷԾ
-                    if (GetBlockTypeID(glm::ivec3(x - 1, y, z)) < (int)BlockType::Grass) {
-                        // ĸ
-                        float textureCoordX = m_BlockTypes[blockTypeID].left.x;
-                        float textureCoordY = m_BlockTypes[blockTypeID].left.y;
-                        m_Vertices.insert(m_Vertices.end(), {
-                            position.x, position.y, position.z + 1.0f,  // 
-                            -1.0f, 0.0f, 0.0f,                         // 
-                            textureCoordX + 1.0f / 64.0f, textureCoordY,
-
-                            position.x, position.y, position.z,  // 
-                            -1.0f, 0.0f, 0.0f,                     // 
-                            textureCoordX, textureCoordY,
-
-                            position.x, position.y + 1.0f, position.z,  // 
-                            - 1.0f, 0.0f, 0.0f,                           // 
-                            textureCoordX, textureCoordY + 1.0f / 32.0f,
-
-                            position.x, position.y + 1.0f, position.z + 1.0f,  // 
-                            -1.0f, 0.0f, 0.0f,                               // 
-                            textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f
-                            });
-                    }
-
-                    if (GetBlockTypeID(glm::ivec3(x + 1, y, z)) < (int)BlockType::Grass) {
-                        // ĸ
-                        float textureCoordX = m_BlockTypes[blockTypeID].right.x;
-                        float textureCoordY = m_BlockTypes[blockTypeID].right.y;
-                        m_Vertices.insert(m_Vertices.end(), {
-                            position.x + 1.0f, position.y, position.z,  // 
-                            1.0f, 0.0f, 0.0f,                             // 
-                            textureCoordX, textureCoordY,
-
-                            position.x + 1.0f, position.y, position.z + 1.0f,  // 
-                            1.0f, 0.0f, 0.0f,                                   // 
-                            textureCoordX + 1.0f / 64.0f, textureCoordY,
-
-                            position.x + 1.0f, position.y + 1.0f, position.z + 1.0f,  // 
-                            1.0f, 0.0f, 0.0f,                                         // 
-                            textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f,
-
-                            position.x + 1.0f, position.y + 1.0f, position.z,  // 
-                            1.0f, 0.0f, 0.0f,                                   // 
-                            textureCoordX, textureCoordY + 1.0f / 32.0f
-                            });
-                    }
-
-                    if (GetBlockTypeID(glm::ivec3(x, y, z - 1)) < (int)BlockType::Grass) {
-                        // ǰĸ
-                        float textureCoordX = m_BlockTypes[blockTypeID].front.x;
-                        float textureCoordY = m_BlockTypes[blockTypeID].front.y;
-                        m_Vertices.insert(m_Vertices.end(), {
-                            position.x, position.y, position.z,  // ǰ
-                            0.0f, 0.0f, -1.0f,                     // 
-                            textureCoordX, textureCoordY,
-
-                            position.x + 1.0f, position.y, position.z,  // ǰ
-                            0.0f, 0.0f, -1.0f,                         // 
-                            textureCoordX + 1.0f / 64.0f, textureCoordY,
-
-                            position.x + 1.0f, position.y + 1.0f, position.z,  // ǰ
-                            0.0f, 0.0f, -1.0f,                                 // 
-                            textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f,
-
-                            position.x, position.y + 1.0f, position.z,  // ǰ
-                            0.0f, 0.0f, -1.0f,                           // 
-                            textureCoordX, textureCoordY + 1.0f / 32.0f
-                            });
-                    }
-
-                    if (GetBlockTypeID(glm::ivec3(x, y, z + 1)) < (int)BlockType::Grass) {
-                        // Ӻĸ
-                        float textureCoordX = m_BlockTypes[blockTypeID].back.x;
-                        float textureCoordY = m_BlockTypes[blockTypeID].back.y;
-                        m_Vertices.insert(m_Vertices.end(), {
-                            position.x + 1.0f, position.y, position.z + 1.0f,  // 
-                            0.0f, 0.0f, 1.0f,                                   // 
-                            textureCoordX + 1.0f / 64.0f, textureCoordY,
-
-                            position.x, position.y, position.z + 1.0f,  // 
-                            0.0f, 0.0f, 1.0f,                             // 
-                            textureCoordX, textureCoordY,
-
-                            position.x, position.y + 1.0f, position.z + 1.0f,  // 
-                            0.0f, 0.0f, 1.0f,                                   // 
-                            textureCoordX, textureCoordY + 1.0f / 32.0f,
-
-                            position.x + 1.0f, position.y + 1.0f, position.z + 1.0f,  // 
-                            0.0f, 0.0f, 1.0f,                                       // 
-                            textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f
-                            });
-                    }
-
-                }
-                else if (blockTypeID == (int)BlockType::Water) { //water block
-                    float textureCoordX = m_BlockTypes[blockTypeID].top.x;
-                    float textureCoordY = m_BlockTypes[blockTypeID].top.y;
-                    if (GetBlockTypeID(glm::ivec3(x, y + 1, z)) != (int)BlockType::Water)
-                    { 
-                        // top face
-                        m_WaterVertices.insert(m_WaterVertices.end(), {
-                            position.x, position.y + 1.0f, position.z,
-                            0.0f, 1.0f, 0.0f,
-                            textureCoordX, textureCoordY,
-
-                            position.x + 1.0f, position.y + 1.0f, position.z,
-                            0.0f, 1.0f, 0.0f,
-                            textureCoordX + 1.0f / 64.0f, textureCoordY,
-
-                            position.x + 1.0f, position.y + 1.0f, position.z + 1.0f,
-                            0.0f, 1.0f, 0.0f,
-                            textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f,
-
-                            position.x, position.y + 1.0f, position.z + 1.0f,
-                            0.0f, 1.0f, 0.0f,
-                            textureCoordX, textureCoordY + 1.0f / 32.0f
-                            });
-                    }
-                }
-                else {  //non-block
-                    float textureCoordX = m_BlockTypes[blockTypeID].front.x;
-                    float textureCoordY = m_BlockTypes[blockTypeID].front.y;
-                    m_BillBoardVertices.insert(m_BillBoardVertices.end(), {
-                        position.x, position.y, position.z,
-                        1.0f, 0.0f, -1.0f,
-                        textureCoordX, textureCoordY,
-
-                        position.x + 1.0f, position.y, position.z + 1.0f,
-                        1.0f, 0.0f, -1.0f,
-                        textureCoordX + 1.0f / 64.0f, textureCoordY,
-
-                        position.x + 1.0f, position.y + 1.0f, position.z + 1.0f,
-                        1.0f, 0.0f, -1.0f,
-                        textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f,
-
-                        position.x, position.y + 1.0f, position.z,
-                        1.0f, 0.0f, -1.0f,
-                        textureCoordX, textureCoordY + 1.0f / 32.0f
-                        });
-                    
-                    textureCoordX = m_BlockTypes[blockTypeID].back.x;
-                    textureCoordY = m_BlockTypes[blockTypeID].back.y;
-                    m_BillBoardVertices.insert(m_BillBoardVertices.end(), {
-                        position.x, position.y, position.z + 1.0f,
-                        -1.0f, 0.0f, -1.0f,
-                        textureCoordX, textureCoordY,
-
-                        position.x + 1.0f, position.y, position.z,
-                        -1.0f, 0.0f, -1.0f,
-                        textureCoordX + 1.0f / 64.0f, textureCoordY,
-
-                        position.x + 1.0f, position.y + 1.0f, position.z,
-                        -1.0f, 0.0f, -1.0f,
-                        textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f,
-
-                        position.x, position.y + 1.0f, position.z + 1.0f,
-                        -1.0f, 0.0f, -1.0f,
-                        textureCoordX, textureCoordY + 1.0f / 32.0f
-                        });
-                }
-			}
-		}
-	}
-
-    // ÿΣ
-    unsigned int vertexCount = m_Vertices.size() / 8; // ÿ 8 
-    for (unsigned int i = 0; i < vertexCount; i += 4) {
-        // ÿĸ
-        m_Indices.push_back(i);
-        m_Indices.push_back(i + 1);
-        m_Indices.push_back(i + 2);
-        m_Indices.push_back(i);
-        m_Indices.push_back(i + 2);
-        m_Indices.push_back(i + 3);
+        TRACE_SCOPE("Chunk Generate");
+        AllocScope allocScope(AllocTag::ChunkGenerate);
+        m_Mesher.Generate(seed);
     }
-    vertexCount = m_BillBoardVertices.size() / 8;
-    for (unsigned int i = 0; i < vertexCount; i += 4) {
-        m_BillBoardIndices.push_back(i);
-        m_BillBoardIndices.push_back(i + 1);
-        m_BillBoardIndices.push_back(i + 2);
-        m_BillBoardIndices.push_back(i);
-        m_BillBoardIndices.push_back(i + 2);
-        m_BillBoardIndices.push_back(i + 3);
-    }
-    vertexCount = m_WaterVertices.size() / 8;
-    for (unsigned int i = 0; i < vertexCount; i += 4) {
-        m_WaterIndices.push_back(i);
-        m_WaterIndices.push_back(i + 1);
-        m_WaterIndices.push_back(i + 2);
-        m_WaterIndices.push_back(i);
-        m_WaterIndices.push_back(i + 2);
-        m_WaterIndices.push_back(i + 3);
+    {
+        TRACE_SCOPE("Chunk Mesh");
+        AllocScope allocScope(AllocTag::ChunkMesh);
+        m_Mesher.Mesh();
     }
-
     m_Generated = true;
+    RenderInitialize(shader);
 
     std::cout << "Generated chunk at pos(" << m_OriginPos.x << ", " << m_OriginPos.y << ", " << m_OriginPos.z << ")" << std::endl;
 }
 
+void Chunk::GetCrossQuad(std::shared_ptr<VertexBuffer>& vbo, std::shared_ptr<IndexBuffer>& ibo)
+{
+    // Shared by every chunk, released together with the last chunk using it
+    vbo = m_CrossQuadVB.lock();
+    ibo = m_CrossQuadIB.lock();
+    if (vbo && ibo)
+        return;
+
+    // Two diagonal quads in block space, texture coordinates relative to the atlas tile
+    static const float crossQuadVertices[] = {
+        0.0f, 0.0f, 0.0f,   1.0f, 0.0f, -1.0f,   0.0f, 0.0f,
+        1.0f, 0.0f, 1.0f,   1.0f, 0.0f, -1.0f,   1.0f / 64.0f, 0.0f,
+        1.0f, 1.0f, 1.0f,   1.0f, 0.0f, -1.0f,   1.0f / 64.0f, 1.0f / 32.0f,
+        0.0f, 1.0f, 0.0f,   1.0f, 0.0f, -1.0f,   0.0f, 1.0f / 32.0f,
+
+        0.0f, 0.0f, 1.0f,  -1.0f, 0.0f, -1.0f,   0.0f, 0.0f,
+        1.0f, 0.0f, 0.0f,  -1.0f, 0.0f, -1.0f,   1.0f / 64.0f, 0.0f,
+        1.0f, 1.0f, 0.0f,  -1.0f, 0.0f, -1.0f,   1.0f / 64.0f, 1.0f / 32.0f,
+        0.0f, 1.0f, 1.0f,  -1.0f, 0.0f, -1.0f,   0.0f, 1.0f / 32.0f
+    };
+    static const unsigned int crossQuadIndices[] = {
+        0, 1, 2, 0, 2, 3,
+        4, 5, 6, 4, 6, 7
+    };
+    vbo = std::make_shared<VertexBuffer>(crossQuadVertices, sizeof(crossQuadVertices));
+    ibo = std::make_shared<IndexBuffer>(crossQuadIndices, 12);
+    m_CrossQuadVB = vbo;
+    m_CrossQuadIB = ibo;
+}
+
 void Chunk::RenderInitialize(std::vector<std::shared_ptr<Shader>> shader)
 {
+    TRACE_SCOPE("Chunk Upload");
+    AllocScope allocScope(AllocTag::ChunkUpload);
+    // Regenerating replaces the buffers of the previous mesh
+    m_va.clear();
+    m_vb.clear();
+    m_ib.clear();
     // Initialize For Rendering
     { // Solid
         // VAO
         auto vao = std::make_shared<VertexArray>();
         vao->Bind();
         // VBO
-        auto vbo = std::make_shared<VertexBuffer>(m_Vertices.data(), m_Vertices.size() * sizeof(float));
+        const std::vector<float>& vertices = m_Mesher.GetVertices();
+        const std::vector<unsigned int>& indices = m_Mesher.GetIndices();
+        auto vbo = std::make_shared<VertexBuffer>(vertices.data(), vertices.size() * sizeof(float));
         // IBO
-        auto ibo = std::make_shared<IndexBuffer>(m_Indices.data(), m_Indices.size());
+        auto ibo = std::make_shared<IndexBuffer>(indices.data(), indices.size());
 
         VertexBufferLayout layout;
         layout.Push<float>(3);
@@ -441,26 +94,38 @@ void Chunk::RenderInitialize(std::vector<std::shared_ptr<Shader>> shader)
         m_vb.push_back(vbo);
         m_ib.push_back(ibo);
     }
-    { // BillBoard
+    { // BillBoard : shared cross quad + per-chunk instance buffer
         auto vao = std::make_shared<VertexArray>();
         vao->Bind();
-        auto vbo = std::make_shared<VertexBuffer>(m_BillBoardVertices.data(), m_BillBoardVertices.size() * sizeof(float));
-        auto ibo = std::make_shared<IndexBuffer>(m_BillBoardIndices.data(), m_BillBoardIndices.size());
+        std::shared_ptr<VertexBuffer> quadVbo;
+        std::shared_ptr<IndexBuffer> quadIbo;
+        GetCrossQuad(quadVbo, quadIbo);
+        quadIbo->Bind(); // element buffer binding is VAO state
         VertexBufferLayout layout;
         layout.Push<float>(3);
         layout.Push<float>(3);
         layout.Push<float>(2);
-        vao->AddBuffer(*vbo, layout);
+        vao->AddBuffer(*quadVbo, layout);
+
+        const std::vector<float>& instances = m_Mesher.GetBillBoardInstances();
+        auto instanceVbo = std::make_shared<VertexBuffer>(instances.data(), instances.size() * sizeof(float));
+        VertexBufferLayout instanceLayout;
+        instanceLayout.Push<float>(3); // block position
+        instanceLayout.Push<float>(2); // atlas coordinate
+        vao->AddInstanceBuffer(*instanceVbo, instanceLayout);
 
         m_va.push_back(vao);
-        m_vb.push_back(vbo);
-        m_ib.push_back(ibo);
+        m_vb.push_back(quadVbo);
+        m_vb.push_back(instanceVbo);
+        m_ib.push_back(quadIbo);
     }
     { // Water
         auto vao = std::make_shared<VertexArray>();
         vao->Bind();
-        auto vbo = std::make_shared<VertexBuffer>(m_WaterVertices.data(), m_WaterVertices.size() * sizeof(float));
-        auto ibo = std::make_shared<IndexBuffer>(m_WaterIndices.data(), m_WaterIndices.size());
+        const std::vector<float>& vertices = m_Mesher.GetWaterVertices();
+        const std::vector<unsigned int>& indices = m_Mesher.GetWaterIndices();
+        auto vbo = std::make_shared<VertexBuffer>(vertices.data(), vertices.size() * sizeof(float));
+        auto ibo = std::make_shared<IndexBuffer>(indices.data(), indices.size());
         VertexBufferLayout layout;
         layout.Push<float>(3);
         layout.Push<float>(3);
@@ -475,6 +140,8 @@ void Chunk::RenderInitialize(std::vector<std::shared_ptr<Shader>> shader)
     //Bind shader file
     m_renderer = std::make_shared<Renderer>(shader);
     m_renderer->SetVAOIBO(m_va, m_ib);
+    m_renderer->SetFaceRanges(m_Mesher.GetFaceRanges(), m_OriginPos, m_OriginPos + glm::vec3((float)m_Mesher.GetChunkSize()));
+    m_renderer->SetBillboardInstances(m_Mesher.GetBillBoardInstances().size() / 5);
     m_renderer->GenerateDepthMap();
 
     m_Initialized = true;
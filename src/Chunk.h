@@ -3,61 +3,26 @@
 #include <glm/glm.hpp>
 #include <iostream>
 
+#include "ChunkMesher.h"
 #include "VertexBufferLayout.h"
 
-// Block Type
-enum class BlockType {
-	Air, Kusa, Daisy, Tulip, Dandelion, Poppy,   // BillBoard
-	Water,	                              //fluid
-	Grass, Dirt, Stone, Sand, Wood,       // Cube 
-	UNDIFINED
-};
-
-// Texture Coords of each side
-struct BlockTextureCoordinates {
-	glm::vec2 left;
-	glm::vec2 right;
-	glm::vec2 top;
-	glm::vec2 bottom;
-	glm::vec2 front;
-	glm::vec2 back;
-};
-
-struct NoiseSettings {
-	float amplitude;
-	float frequency;
-	float offset;
-};
-
 class Chunk
 {
 public:
 	Chunk(int chunkSize, glm::vec3 originPos);
 	~Chunk();
 
-	void Generate(unsigned int seed);
-	std::vector<float> GetVertices() { return m_Vertices; }
-	std::vector<unsigned int> GetIndices() { return m_Indices; }
-	void RenderInitialize(std::vector<std::shared_ptr<Shader>> shader);
+	// Generate, mesh and upload; the mesh only lives in the mesher's scratch until the upload
+	void Generate(unsigned int seed, std::vector<std::shared_ptr<Shader>> shader);
 	std::shared_ptr<Renderer> GetRenderer() { return m_renderer; };
-	int GetBlockTypeID(glm::ivec3 index);
+	int GetBlockTypeID(glm::ivec3 index) { return m_Mesher.GetBlockTypeID(index); }
 
 private:
-	void LoadBlockTextures();
+	void RenderInitialize(std::vector<std::shared_ptr<Shader>> shader);
+	static void GetCrossQuad(std::shared_ptr<VertexBuffer>& vbo, std::shared_ptr<IndexBuffer>& ibo);
 
 private:
-	int m_ChunkSize;
-	std::vector<int> data;
-
-	std::vector<float> m_Vertices;
-	std::vector<unsigned int> m_Indices;
-	std::vector<float> m_BillBoardVertices;
-	std::vector<unsigned int> m_BillBoardIndices;
-	std::vector<float> m_WaterVertices;
-	std::vector<unsigned int> m_WaterIndices;
-
-	std::vector<BlockTextureCoordinates> m_BlockTypes;
-	std::vector<NoiseSettings> m_NoiseSettings;
+	ChunkMesher m_Mesher;
 
 	bool m_Generated = false;
 	bool m_Initialized = false;
@@ -67,4 +32,7 @@ private:
 	std::vector<std::shared_ptr<IndexBuffer>>  m_ib;
 	std::vector<std::shared_ptr<VertexBuffer>> m_vb;
 	std::shared_ptr<Renderer> m_renderer;
+
+	static std::weak_ptr<VertexBuffer> m_CrossQuadVB;
+	static std::weak_ptr<IndexBuffer>  m_CrossQuadIB;
 };
\ No newline at end of file
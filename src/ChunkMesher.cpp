@@ -0,0 +1,515 @@
+#include "ChunkMesher.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <initializer_list>
+#include "vendor/OpenSimplexNoise.hh"
+#include <stdexcept>
+#include <string>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// Number of set bits
+static inline int CountBits(uint64_t bits)
+{
+#ifdef _MSC_VER
+    return (int)__popcnt64(bits);
+#else
+    return __builtin_popcountll(bits);
+#endif
+}
+
+// Index of the lowest set bit, bits must not be 0
+static inline int LowestBit(uint64_t bits)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return (int)index;
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+// What the getters return before the first Mesh()
+static const MeshScratch s_NoMesh;
+
+ChunkMesher::ChunkMesher(int chunkSize, glm::vec3 originPos)
+{
+	m_ChunkSize = chunkSize + 2; // һȦŻɣ
+	// A column including its border has to fit the 64-bit ColumnMasks
+	if (chunkSize <= 0 || chunkSize > CHUNK_MAX_SIZE)
+		throw std::runtime_error("Chunk size " + std::to_string(chunkSize) + " is outside 1.." + std::to_string(CHUNK_MAX_SIZE));
+	data.resize(m_ChunkSize * m_ChunkSize * m_ChunkSize);
+    m_Columns.resize(m_ChunkSize * m_ChunkSize);
+    LoadBlockTextures();
+    m_OriginPos = originPos;
+    m_Mesh = &s_NoMesh;
+
+    m_NoiseSettings.resize(2);
+    m_NoiseSettings[0] = { 20.0f,0.01f,0.0f };
+    m_NoiseSettings[1] = { 3.0f,0.05f,0.0f };
+}
+
+// ʵʵindex(0-based)ȡdataиλõķ
+int ChunkMesher::GetBlockTypeID(glm::ivec3 index)
+{
+	/*      y
+            |
+            O -- x
+           /
+          z
+	*/
+    int type = data[index.x + 1 + (index.y + 1) * m_ChunkSize + (index.z + 1) * m_ChunkSize * m_ChunkSize];
+	return type;
+}
+
+void ChunkMesher::LoadBlockTextures()
+{
+    constexpr int BlockTypeCount = static_cast<int>(BlockType::UNDIFINED);
+    m_BlockTypes.resize(BlockTypeCount);
+    for (int i = 0; i < BlockTypeCount; i++)
+    {
+        switch (i)
+        {
+        case (int)BlockType::Grass:
+            m_BlockTypes[i].left   = glm::vec2(25.0f / 64.0f, 23.0f / 32.0f);
+            m_BlockTypes[i].right  = glm::vec2(25.0f / 64.0f, 23.0f / 32.0f);
+            m_BlockTypes[i].top    = glm::vec2(11.0f / 64.0f, 14.0f / 32.0f);
+            m_BlockTypes[i].bottom = glm::vec2(21.0f / 64.0f, 18.0f / 32.0f);
+            m_BlockTypes[i].front  = glm::vec2(25.0f / 64.0f, 23.0f / 32.0f);
+            m_BlockTypes[i].back   = glm::vec2(25.0f / 64.0f, 23.0f / 32.0f);
+            break;
+        case (int)BlockType::Dirt:
+            m_BlockTypes[i].left   = glm::vec2(21.0f / 64.0f, 18.0f / 32.0f);
+            m_BlockTypes[i].right  = glm::vec2(21.0f / 64.0f, 18.0f / 32.0f);
+            m_BlockTypes[i].top    = glm::vec2(21.0f / 64.0f, 18.0f / 32.0f);
+            m_BlockTypes[i].bottom = glm::vec2(21.0f / 64.0f, 18.0f / 32.0f);
+            m_BlockTypes[i].front  = glm::vec2(21.0f / 64.0f, 18.0f / 32.0f);
+            m_BlockTypes[i].back   = glm::vec2(21.0f / 64.0f, 18.0f / 32.0f);
+            break;
+        case (int)BlockType::Stone:
+            m_BlockTypes[i].left   = glm::vec2(6.0f / 64.0f, 5.0f / 32.0f);
+            m_BlockTypes[i].right  = glm::vec2(6.0f / 64.0f, 5.0f / 32.0f);
+            m_BlockTypes[i].top    = glm::vec2(6.0f / 64.0f, 5.0f / 32.0f);
+            m_BlockTypes[i].bottom = glm::vec2(6.0f / 64.0f, 5.0f / 32.0f);
+            m_BlockTypes[i].front  = glm::vec2(6.0f / 64.0f, 5.0f / 32.0f);
+            m_BlockTypes[i].back   = glm::vec2(6.0f / 64.0f, 5.0f / 32.0f);
+            break;
+        case (int)BlockType::Kusa:
+            m_BlockTypes[i].front = glm::vec2(10.0f / 64.0f, 7.0f / 32.0f);
+            m_BlockTypes[i].back =  glm::vec2(10.0f / 64.0f, 7.0f / 32.0f);
+            break;
+        case (int)BlockType::Daisy:
+            m_BlockTypes[i].front = glm::vec2(29.0f / 64.0f, 13.0f / 32.0f);
+            m_BlockTypes[i].back =  glm::vec2(29.0f / 64.0f, 13.0f / 32.0f);
+            break;
+        case (int)BlockType::Tulip:
+            m_BlockTypes[i].front = glm::vec2(17.0f / 64.0f, 12.0f / 32.0f);
+            m_BlockTypes[i].back =  glm::vec2(17.0f / 64.0f, 12.0f / 32.0f);
+            break;
+        case (int)BlockType::Dandelion:
+            m_BlockTypes[i].front = glm::vec2(18.0f / 64.0f, 28.0f / 32.0f);
+            m_BlockTypes[i].back =  glm::vec2(18.0f / 64.0f, 28.0f / 32.0f);
+            break;
+        case (int)BlockType::Poppy:
+            m_BlockTypes[i].front = glm::vec2(21.0f / 64.0f, 11.0f / 32.0f);
+            m_BlockTypes[i].back =  glm::vec2(21.0f / 64.0f, 11.0f / 32.0f);
+            break;
+        case (int)BlockType::Water:
+            m_BlockTypes[i].left   = glm::vec2(63.0f / 64.0f, 0.0f / 32.0f);
+            m_BlockTypes[i].right  = glm::vec2(63.0f / 64.0f, 0.0f / 32.0f);
+            m_BlockTypes[i].top    = glm::vec2(6.0f  / 64.0f, 28.0f / 32.0f);
+            m_BlockTypes[i].bottom = glm::vec2(63.0f / 64.0f, 0.0f / 32.0f);
+            m_BlockTypes[i].front  = glm::vec2(63.0f / 64.0f, 0.0f / 32.0f);
+            m_BlockTypes[i].back   = glm::vec2(63.0f / 64.0f, 0.0f / 32.0f);
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+void ChunkMesher::Generate(unsigned int seed)
+{
+	// NOTE: y value is the UP axis
+
+    static OSN::Noise<2> noise2D(seed);
+    static unsigned int noiseSeed = seed;
+    if (seed != noiseSeed)
+    {
+        noise2D = OSN::Noise<2>(seed);
+        noiseSeed = seed;
+    }
+    static int waterLevel = 18;
+    //OSN::Noise<3> noise3D(seed);
+
+    // Generating Step
+	int height = 0;
+	for (int z = 0; z < m_ChunkSize; z++)
+	{
+		for (int x = 0; x < m_ChunkSize; x++)
+		{
+            float noiseValue2D = 0.0f;
+            float normalizeNum = 0.0f;
+            for (int i = 0; i < m_NoiseSettings.size(); i++)
+            {
+                noiseValue2D += noise2D.eval(
+                    (float)((x - 1 + m_OriginPos.x) * m_NoiseSettings[i].frequency) + m_NoiseSettings[i].offset,
+                    (float)((z - 1 + m_OriginPos.z) * m_NoiseSettings[i].frequency) + m_NoiseSettings[i].offset)
+                    * m_NoiseSettings[i].amplitude;
+                normalizeNum += m_NoiseSettings[i].amplitude;
+            }
+            noiseValue2D = (noiseValue2D + normalizeNum) / 2 / normalizeNum;
+            height = (int)(pow(noiseValue2D, 1) * m_ChunkSize);
+            
+            // block data
+            for (int y = 0; y < height / 2; y++)
+                data[x + y * m_ChunkSize + z * m_ChunkSize * m_ChunkSize] = (int)BlockType::Stone;
+			for (int y = height / 2; y < height - 1; y++)
+				data[x + y * m_ChunkSize + z * m_ChunkSize * m_ChunkSize] = (int)BlockType::Dirt;
+            // The top is Grass Block
+            if (height > 0)
+                data[x + (height - 1) * m_ChunkSize + z * m_ChunkSize * m_ChunkSize] = (int)BlockType::Grass;
+            // Water
+            if (height < waterLevel)
+            {
+                // Chunks lower than the water level are filled to their top
+                for (int y = height; y < std::min(waterLevel, m_ChunkSize); y++)
+                    data[x + y * m_ChunkSize + z * m_ChunkSize * m_ChunkSize] = (int)BlockType::Water;
+                continue; // no need to generate flowers etc.
+            }
+            // Random Kusa
+            if (rand() % 20 == 0 && height != 0 && height < m_ChunkSize)
+                data[x + height * m_ChunkSize + z * m_ChunkSize * m_ChunkSize] = (int)BlockType::Kusa;
+            // Random Flower
+            if (rand() % 50 == 0 && height != 0 && height < m_ChunkSize)
+            {
+                int flowerTypeNum = (int)BlockType::Grass - (int)BlockType::Daisy;
+                data[x + height * m_ChunkSize + z * m_ChunkSize * m_ChunkSize] = (int)BlockType::Kusa + rand() % flowerTypeNum;
+            }
+		}
+	}
+    BuildColumns();
+}
+
+void ChunkMesher::BuildColumns()
+{
+    for (int z = 0; z < m_ChunkSize; z++)
+    {
+        for (int x = 0; x < m_ChunkSize; x++)
+        {
+            ColumnMasks column;
+            for (int y = 0; y < m_ChunkSize; y++)
+            {
+                int type = data[x + y * m_ChunkSize + z * m_ChunkSize * m_ChunkSize];
+                uint64_t bit = 1ull << y;
+                if (type >= (int)BlockType::Grass)
+                    column.solid |= bit;
+                else if (type == (int)BlockType::Water)
+                    column.water |= bit;
+                else if (type != (int)BlockType::Air)
+                    column.plant |= bit;
+            }
+            m_Columns[x + z * m_ChunkSize] = column;
+        }
+    }
+}
+
+// Two triangles per quad of four vertices
+static void FillQuadIndices(unsigned int* out, unsigned int quadCount)
+{
+    for (unsigned int i = 0; i < quadCount * 4; i += 4)
+    {
+        *out++ = i;
+        *out++ = i + 1;
+        *out++ = i + 2;
+        *out++ = i;
+        *out++ = i + 2;
+        *out++ = i + 3;
+    }
+}
+
+MeshScratch& ChunkMesher::GetScratch()
+{
+    static thread_local MeshScratch scratch;
+    return scratch;
+}
+
+// Copy one quad (or billboard instance) to out and advance it; the list lives on the stack
+static inline void EmitQuad(float*& out, std::initializer_list<float> values)
+{
+    std::copy(values.begin(), values.end(), out);
+    out += values.size();
+}
+
+void ChunkMesher::Mesh()
+{
+    // Everything is written into this thread's scratch buffers, which keep their capacity
+    // from chunk to chunk: once they have grown to the largest chunk, meshing allocates nothing
+    MeshScratch& mesh = GetScratch();
+    m_Mesh = &mesh;
+    m_MeshGeneration = ++mesh.generation;
+    int size = m_ChunkSize - 2;
+    mesh.columnFaces.resize(size * size);
+
+    // Pre-pass: the visible faces of each column from the occupancy masks, a whole column
+    // at a time, and how many of each kind there are so every output buffer is sized once
+    const uint64_t inside = ((1ull << size) - 1) << 1; // the column without its border bits
+    unsigned int faceCounts[(int)FaceDir::UNDIFINED] = {};
+    unsigned int waterCount = 0, billboardCount = 0;
+    for (int z = 0; z < size; z++)
+    {
+        for (int x = 0; x < size; x++)
+        {
+            const ColumnMasks& column = GetColumn(x, z);
+            uint64_t solid = column.solid & inside;
+            ColumnFaces& faces = mesh.columnFaces[x + z * size];
+            // A cube face shows where the neighbour is not a cube. No bottom faces, see below
+            faces.solid[(int)FaceDir::PosY] = solid & ~(column.solid >> 1);
+            faces.solid[(int)FaceDir::NegY] = 0;
+            faces.solid[(int)FaceDir::NegX] = solid & ~GetColumn(x - 1, z).solid;
+            faces.solid[(int)FaceDir::PosX] = solid & ~GetColumn(x + 1, z).solid;
+            faces.solid[(int)FaceDir::NegZ] = solid & ~GetColumn(x, z - 1).solid;
+            faces.solid[(int)FaceDir::PosZ] = solid & ~GetColumn(x, z + 1).solid;
+            // Water only has a surface, where the block above is not water
+            faces.water = column.water & inside & ~(column.water >> 1);
+            faces.plant = column.plant & inside;
+
+            for (int f = 0; f < (int)FaceDir::UNDIFINED; f++)
+                faceCounts[f] += CountBits(faces.solid[f]);
+            waterCount += CountBits(faces.water);
+            billboardCount += CountBits(faces.plant);
+        }
+    }
+
+    // Solid faces are bucketed by direction so whole buckets can be skipped; each bucket
+    // gets its final place in the vertex buffer up front
+    unsigned int quadCount = 0;
+    mesh.faceRanges.resize((int)FaceDir::UNDIFINED);
+    for (int f = 0; f < (int)FaceDir::UNDIFINED; f++)
+    {
+        mesh.faceRanges[f] = { quadCount * 6, faceCounts[f] * 6 };
+        quadCount += faceCounts[f];
+    }
+    mesh.vertices.resize(quadCount * 32); // 4 vertices * 8 floats
+    mesh.waterVertices.resize(waterCount * 32);
+    mesh.billboardInstances.resize(billboardCount * 5);
+    float* cursor[(int)FaceDir::UNDIFINED];
+    for (int f = 0; f < (int)FaceDir::UNDIFINED; f++)
+        cursor[f] = mesh.vertices.data() + mesh.faceRanges[f].offset / 6 * 32;
+    float* waterCursor = mesh.waterVertices.data();
+    float* billboardCursor = mesh.billboardInstances.data();
+
+	// Rendering Optimize : BATCH RENDERING
+	for (int z = 0; z < m_ChunkSize - 2; z++)
+	{
+		for (int x = 0; x < m_ChunkSize - 2; x++)
+		{
+            // Visit only the blocks that emit something, bottom up
+            const ColumnFaces& columnFaces = mesh.columnFaces[x + z * size];
+            uint64_t blocks = columnFaces.water | columnFaces.plant;
+            for (int f = 0; f < (int)FaceDir::UNDIFINED; f++)
+                blocks |= columnFaces.solid[f];
+			while (blocks)
+			{
+                int bit = LowestBit(blocks);
+                blocks &= blocks - 1;
+                int y = bit - 1;
+                int blockTypeID = GetBlockTypeID(glm::ivec3(x, y, z));
+                unsigned int faces = (unsigned int)((columnFaces.water >> bit) & 1) << (int)FaceDir::PosY;
+                for (int f = 0; f < (int)FaceDir::UNDIFINED; f++)
+                    faces |= (unsigned int)((columnFaces.solid[f] >> bit) & 1) << f;
+
+				// ǰλ
+				glm::vec3 position(x, y, z);
+                position += m_OriginPos; //offset
+
+                if (blockTypeID >= (int)BlockType::Grass) //Block
+                {
+                    // 
+                    // 棨ʱҪ
+                    /*if (y == 0 || GetBlockTypeID(glm::ivec3(x, y - 1, z)) < (int)BlockType::Grass) {
+                        // ӵĸ
+                        float textureCoordX = m_BlockTypes[blockTypeID].bottom.x;
+                        float textureCoordY = m_BlockTypes[blockTypeID].bottom.y;
+                        EmitQuad(cursor[(int)FaceDir::NegY], {
+                            position.x + 1.0f, position.y, position.z,  // 
+                            0.0f, -1.0f, 0.0f,                           // 
+                            textureCoordX + 1.0f / 64.0f, textureCoordY, // 
+
+                            position.x, position.y, position.z,  // 
+                            0.0f, -1.0f, 0.0f,                     // 
+                            textureCoordX, textureCoordY,         // 
+
+                            position.x, position.y, position.z + 1.0f,  // 
+                            0.0f, -1.0f, 0.0f,                           // 
+                            textureCoordX, textureCoordY + 1.0f / 32.0f,  // 
+
+                            position.x + 1.0f, position.y, position.z + 1.0f,  // 
+                            0.0f, -1.0f, 0.0f,                               // 
+                            textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f // 
+                            });
+                    }*/
+
+                    // 
+                    if (faces & (1u << (int)FaceDir::PosY)) {
+                        // Ӷĸ
+                        float textureCoordX = m_BlockTypes[blockTypeID].top.x;
+                        float textureCoordY = m_BlockTypes[blockTypeID].top.y;
+                        EmitQuad(cursor[(int)FaceDir::PosY], {
+                            position.x, position.y + 1.0f, position.z,  // 
+                            0.0f, 1.0f, 0.0f,                       // 
+                            textureCoordX, textureCoordY,          // 
+
+                            position.x + 1.0f, position.y + 1.0f, position.z,  // 
+                            0.0f, 1.0f, 0.0f,                               // 
+                            textureCoordX + 1.0f / 64.0f, textureCoordY, // 
+
+                            position.x + 1.0f, position.y + 1.0f, position.z + 1.0f,  // 
+                            0.0f, 1.0f, 0.0f,                                       // 
+                            textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f, // 
+
+                            position.x, position.y + 1.0f, position.z + 1.0f,  // 
+                            0.0f, 1.0f, 0.0f,                                   // 
+                            textureCoordX, textureCoordY + 1.0f / 32.0f // 
+                            });
+                    }
+
+                    // ڷԾ
+                    if (faces & (1u << (int)FaceDir::NegX)) {
+                        // ĸ
+                        float textureCoordX = m_BlockTypes[blockTypeID].left.x;
+                        float textureCoordY = m_BlockTypes[blockTypeID].left.y;
+                        EmitQuad(cursor[(int)FaceDir::NegX], {
+                            position.x, position.y, position.z + 1.0f,  // 
+                            -1.0f, 0.0f, 0.0f,                         // 
+                            textureCoordX + 1.0f / 64.0f, textureCoordY,
+
+                            position.x, position.y, position.z,  // 
+                            -1.0f, 0.0f, 0.0f,                     // 
+                            textureCoordX, textureCoordY,
+
+                            position.x, position.y + 1.0f, position.z,  // 
+                            - 1.0f, 0.0f, 0.0f,                           // 
+                            textureCoordX, textureCoordY + 1.0f / 32.0f,
+
+                            position.x, position.y + 1.0f, position.z + 1.0f,  // 
+                            -1.0f, 0.0f, 0.0f,                               // 
+                            textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f
+                            });
+                    }
+
+                    if (faces & (1u << (int)FaceDir::PosX)) {
+                        // ĸ
+                        float textureCoordX = m_BlockTypes[blockTypeID].right.x;
+                        float textureCoordY = m_BlockTypes[blockTypeID].right.y;
+                        EmitQuad(cursor[(int)FaceDir::PosX], {
+                            position.x + 1.0f, position.y, position.z,  // 
+                            1.0f, 0.0f, 0.0f,                             // 
+                            textureCoordX, textureCoordY,
+
+                            position.x + 1.0f, position.y, position.z + 1.0f,  // 
+                            1.0f, 0.0f, 0.0f,                                   // 
+                            textureCoordX + 1.0f / 64.0f, textureCoordY,
+
+                            position.x + 1.0f, position.y + 1.0f, position.z + 1.0f,  // 
+                            1.0f, 0.0f, 0.0f,                                         // 
+                            textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f,
+
+                            position.x + 1.0f, position.y + 1.0f, position.z,  // 
+                            1.0f, 0.0f, 0.0f,                                   // 
+                            textureCoordX, textureCoordY + 1.0f / 32.0f
+                            });
+                    }
+
+                    if (faces & (1u << (int)FaceDir::NegZ)) {
+                        // ǰĸ
+                        float textureCoordX = m_BlockTypes[blockTypeID].front.x;
+                        float textureCoordY = m_BlockTypes[blockTypeID].front.y;
+                        EmitQuad(cursor[(int)FaceDir::NegZ], {
+                            position.x, position.y, position.z,  // ǰ
+                            0.0f, 0.0f, -1.0f,                     // 
+                            textureCoordX, textureCoordY,
+
+                            position.x + 1.0f, position.y, position.z,  // ǰ
+                            0.0f, 0.0f, -1.0f,                         // 
+                            textureCoordX + 1.0f / 64.0f, textureCoordY,
+
+                            position.x + 1.0f, position.y + 1.0f, position.z,  // ǰ
+                            0.0f, 0.0f, -1.0f,                                 // 
+                            textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f,
+
+                            position.x, position.y + 1.0f, position.z,  // ǰ
+                            0.0f, 0.0f, -1.0f,                           // 
+                            textureCoordX, textureCoordY + 1.0f / 32.0f
+                            });
+                    }
+
+                    if (faces & (1u << (int)FaceDir::PosZ)) {
+                        // Ӻĸ
+                        float textureCoordX = m_BlockTypes[blockTypeID].back.x;
+                        float textureCoordY = m_BlockTypes[blockTypeID].back.y;
+                        EmitQuad(cursor[(int)FaceDir::PosZ], {
+                            position.x + 1.0f, position.y, position.z + 1.0f,  // 
+                            0.0f, 0.0f, 1.0f,                                   // 
+                            textureCoordX + 1.0f / 64.0f, textureCoordY,
+
+                            position.x, position.y, position.z + 1.0f,  // 
+                            0.0f, 0.0f, 1.0f,                             // 
+                            textureCoordX, textureCoordY,
+
+                            position.x, position.y + 1.0f, position.z + 1.0f,  // 
+                            0.0f, 0.0f, 1.0f,                                   // 
+                            textureCoordX, textureCoordY + 1.0f / 32.0f,
+
+                            position.x + 1.0f, position.y + 1.0f, position.z + 1.0f,  // 
+                            0.0f, 0.0f, 1.0f,                                       // 
+                            textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f
+                            });
+                    }
+
+                }
+                else if (blockTypeID == (int)BlockType::Water) { //water block
+                    float textureCoordX = m_BlockTypes[blockTypeID].top.x;
+                    float textureCoordY = m_BlockTypes[blockTypeID].top.y;
+                    if (faces & (1u << (int)FaceDir::PosY))
+                    { 
+                        // top face
+                        EmitQuad(waterCursor, {
+                            position.x, position.y + 1.0f, position.z,
+                            0.0f, 1.0f, 0.0f,
+                            textureCoordX, textureCoordY,
+
+                            position.x + 1.0f, position.y + 1.0f, position.z,
+                            0.0f, 1.0f, 0.0f,
+                            textureCoordX + 1.0f / 64.0f, textureCoordY,
+
+                            position.x + 1.0f, position.y + 1.0f, position.z + 1.0f,
+                            0.0f, 1.0f, 0.0f,
+                            textureCoordX + 1.0f / 64.0f, textureCoordY + 1.0f / 32.0f,
+
+                            position.x, position.y + 1.0f, position.z + 1.0f,
+                            0.0f, 1.0f, 0.0f,
+                            textureCoordX, textureCoordY + 1.0f / 32.0f
+                            });
+                    }
+                }
+                else {  //non-block
+                    // One instance per plant: block position + atlas coordinate of its type
+                    EmitQuad(billboardCursor, {
+                        position.x, position.y, position.z,
+                        m_BlockTypes[blockTypeID].front.x, m_BlockTypes[blockTypeID].front.y
+                        });
+                }
+			}
+		}
+	}
+
+    // ÿΣ
+    mesh.indices.resize(quadCount * 6);
+    FillQuadIndices(mesh.indices.data(), quadCount);
+    mesh.waterIndices.resize(waterCount * 6);
+    FillQuadIndices(mesh.waterIndices.data(), waterCount);
+}
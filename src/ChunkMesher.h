@@ -0,0 +1,128 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <glm/glm.hpp>
+
+// Terrain generation and CPU meshing of one chunk. Nothing in here touches GL,
+// so it also runs without a context (bench/ChunkBenchmark.cpp).
+
+// Largest chunk size: a column of blocks plus the border has to fit one 64-bit mask.
+// Every size from 1 up is valid; Generate clips water and plants to the chunk top.
+#define CHUNK_MAX_SIZE 62
+
+// Block Type
+enum class BlockType {
+	Air, Kusa, Daisy, Tulip, Dandelion, Poppy,   // BillBoard
+	Water,	                              //fluid
+	Grass, Dirt, Stone, Sand, Wood,       // Cube
+	UNDIFINED
+};
+
+// Texture Coords of each side
+struct BlockTextureCoordinates {
+	glm::vec2 left;
+	glm::vec2 right;
+	glm::vec2 top;
+	glm::vec2 bottom;
+	glm::vec2 front;
+	glm::vec2 back;
+};
+
+struct NoiseSettings {
+	float amplitude;
+	float frequency;
+	float offset;
+};
+
+// Face direction buckets of the solid mesh (outward normal)
+enum class FaceDir {
+	PosX, NegX,
+	PosY, NegY,
+	PosZ, NegZ,
+	UNDIFINED
+};
+
+// Index range of one face bucket inside the solid IBO
+struct IndexRange {
+	unsigned int offset = 0;
+	unsigned int count = 0;
+};
+
+// Block occupancy of one (x, z) column of the chunk, bit y + 1 for block y (bit 0 and
+// bit size + 1 are the border). Kept next to the block data so face culling and other
+// neighbour tests work on a whole column with shifts and ANDs.
+struct ColumnMasks {
+	uint64_t solid = 0; // cubes, Grass and up
+	uint64_t water = 0;
+	uint64_t plant = 0; // billboards
+};
+
+// Visible faces of one column, same bit layout as ColumnMasks
+struct ColumnFaces {
+	uint64_t solid[(int)FaceDir::UNDIFINED];
+	uint64_t water;     // water surfaces
+	uint64_t plant;
+};
+
+// Mesh output of one thread. It is reused by every Mesh() on that thread and only grows,
+// so steady-state meshing does not allocate.
+struct MeshScratch
+{
+	std::vector<float> vertices;
+	std::vector<unsigned int> indices;
+	std::vector<IndexRange> faceRanges; // indices grouped by FaceDir
+	std::vector<float> billboardInstances; // x, y, z, u, v per plant
+	std::vector<float> waterVertices;
+	std::vector<unsigned int> waterIndices;
+	std::vector<ColumnFaces> columnFaces; // per (x, z) column, from the pre-pass
+	unsigned int generation = 0; // bumped by every Mesh() into this scratch
+};
+
+class ChunkMesher
+{
+public:
+	ChunkMesher(int chunkSize, glm::vec3 originPos);
+
+	// Fill the block data from the height noise
+	void Generate(unsigned int seed);
+	// Rebuild all meshes from the block data into this thread's MeshScratch.
+	// The getters below read that scratch: use (upload) them before the thread meshes another chunk,
+	// they assert once it has been overwritten.
+	void Mesh();
+	int GetBlockTypeID(glm::ivec3 index);
+	// Occupancy of the column at (x, z), -1 and GetChunkSize() are the border
+	const ColumnMasks& GetColumn(int x, int z) const { return m_Columns[x + 1 + (z + 1) * m_ChunkSize]; }
+	bool IsSolid(glm::ivec3 index) const { return (GetColumn(index.x, index.z).solid >> (index.y + 1)) & 1; }
+
+	int GetChunkSize() const { return m_ChunkSize - 2; }
+	const std::vector<float>& GetVertices() const { return GetMesh().vertices; }
+	const std::vector<unsigned int>& GetIndices() const { return GetMesh().indices; }
+	const std::vector<IndexRange>& GetFaceRanges() const { return GetMesh().faceRanges; }
+	const std::vector<float>& GetBillBoardInstances() const { return GetMesh().billboardInstances; }
+	const std::vector<float>& GetWaterVertices() const { return GetMesh().waterVertices; }
+	const std::vector<unsigned int>& GetWaterIndices() const { return GetMesh().waterIndices; }
+
+private:
+	void LoadBlockTextures();
+	// Rebuild m_Columns from the block data
+	void BuildColumns();
+	static MeshScratch& GetScratch();
+	const MeshScratch& GetMesh() const
+	{
+		assert(m_Mesh->generation == m_MeshGeneration && "mesh scratch reused by another chunk");
+		return *m_Mesh;
+	}
+
+private:
+	int m_ChunkSize; // including the one block border
+	std::vector<int> data;
+	std::vector<ColumnMasks> m_Columns; // m_ChunkSize * m_ChunkSize, x fastest
+	glm::vec3 m_OriginPos;
+
+	const MeshScratch* m_Mesh; // where the last Mesh() wrote
+	unsigned int m_MeshGeneration = 0; // its generation right after that Mesh()
+
+	std::vector<BlockTextureCoordinates> m_BlockTypes;
+	std::vector<NoiseSettings> m_NoiseSettings;
+};
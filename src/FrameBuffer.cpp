@@ -1,5 +1,9 @@
 #include "FrameBuffer.h"
 #include "Renderer.h"
+#include "GLState.h"
+#include "RenderStats.h"
+
+#include <algorithm>
 
 static float rectangleVertices[] =
 {
@@ -13,141 +17,256 @@ static float rectangleVertices[] =
    -1.0f,  1.0f,  0.0f, 1.0f
 };
 
-FrameBuffer::FrameBuffer(int width, int height)
+FrameBuffer::FrameBuffer(int width, int height, const FrameBufferFormat& format)
+    : m_WindowWidth(width), m_WindowHeight(height), m_RenderScale(1.0f), m_Width(width), m_Height(height),
+      m_Format(format)
 {
-    glGenFramebuffers(1, &m_RendererID);
-    glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
-
-    glGenTextures(2, m_FrameBufferTexture);
-    for (unsigned int i = 0; i < 2; i++)
-    {
-        glBindTexture(GL_TEXTURE_2D, m_FrameBufferTexture[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, m_FrameBufferTexture[i], 0);
-    }
+    glGenTextures(1, &m_FrameBufferTexture);
+    GLState::BindTexture(0, m_FrameBufferTexture);
+    // Bilinear for the upscale to the window; at full scale it samples texel centers anyway
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
     glGenTextures(1, &m_DepthTexture);
-    glBindTexture(GL_TEXTURE_2D, m_DepthTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    GLState::BindTexture(0, m_DepthTexture);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+
+    // Bloom mip chain, one FBO per level
+    glGenFramebuffers(BLOOM_MIPS, m_BloomFBO);
+    glGenTextures(BLOOM_MIPS, m_BloomMip);
+    for (int i = 0; i < BLOOM_MIPS; i++)
+    {
+        GLState::BindTexture(0, m_BloomMip[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    Allocate();
+
+    // Only HDR colour and depth; the bright pass is part of the first bloom downsample
+    glGenFramebuffers(1, &m_RendererID);
+    GLState::BindFramebuffer(m_RendererID);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_FrameBufferTexture, 0);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_DepthTexture, 0);
 
     auto fboStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
     if (fboStatus != GL_FRAMEBUFFER_COMPLETE)
         std::cout << "Framebuffer error: " << fboStatus << '\n';
 
-    // Multiple Render Targets
-    GLuint attachments[2] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1 };
-    glDrawBuffers(2, attachments);
+    for (int i = 0; i < BLOOM_MIPS; i++)
+    {
+        GLState::BindFramebuffer(m_BloomFBO[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_BloomMip[i], 0);
+    }
 
     glGenVertexArrays(1, &m_rectVAO);
     glGenBuffers(1, &m_rectVBO);
-    glBindVertexArray(m_rectVAO);
+    GLState::BindVertexArray(m_rectVAO);
     glBindBuffer(GL_ARRAY_BUFFER, m_rectVBO);
     glBufferData(GL_ARRAY_BUFFER, sizeof(rectangleVertices), &rectangleVertices, GL_STATIC_DRAW);
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(1);
     glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
-
-    // FBO used for Gaussian Blur
-    glGenFramebuffers(2, m_GaussianBlurFBO);
-    glGenTextures(2, m_GaussianBlurBuffer);
-    for (GLuint i = 0; i < 2; i++)
-    {
-        glBindFramebuffer(GL_FRAMEBUFFER, m_GaussianBlurFBO[i]);
-        glBindTexture(GL_TEXTURE_2D, m_GaussianBlurBuffer[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_GaussianBlurBuffer[i], 0);
-    }
 }
 
 FrameBuffer::~FrameBuffer()
 {
-    glDeleteTextures(1, &m_FrameBufferTexture[0]);
-    glDeleteTextures(1, &m_FrameBufferTexture[1]);
+    GLState::ForgetTexture(m_FrameBufferTexture);
+    GLState::ForgetTexture(m_DepthTexture);
+    glDeleteTextures(1, &m_FrameBufferTexture);
     glDeleteTextures(1, &m_DepthTexture);
+    for (int i = 0; i < BLOOM_MIPS; i++)
+        GLState::ForgetTexture(m_BloomMip[i]);
+    glDeleteTextures(BLOOM_MIPS, m_BloomMip);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::BindFramebuffer(0);
     glDeleteFramebuffers(1, &m_RendererID);
+    glDeleteFramebuffers(BLOOM_MIPS, m_BloomFBO);
 
-    glBindVertexArray(0);
+    GLState::BindVertexArray(0);
     glDeleteVertexArrays(1, &m_rectVAO);
     glDeleteBuffers(1, &m_rectVBO);
 }
 
 void FrameBuffer::Bind() const
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, m_RendererID);
+    GLState::BindFramebuffer(m_RendererID);
 }
 
 void FrameBuffer::Unbind() const
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::BindFramebuffer(0);
 }
 
-void FrameBuffer::Render() const
+void FrameBuffer::Render(unsigned int target) const
 {
-    Unbind();
+    GLState::BindFramebuffer(target);
+    glViewport(0, 0, m_WindowWidth, m_WindowHeight);
     glClear(GL_COLOR_BUFFER_BIT);
 
-    glBindVertexArray(m_rectVAO);
-    glActiveTexture(GL_TEXTURE0 + m_FrameBufferTexture[0]);
-    glBindTexture(GL_TEXTURE_2D, m_FrameBufferTexture[0]);
-    glActiveTexture(GL_TEXTURE0 + m_FrameBufferTexture[1]);
-    glBindTexture(GL_TEXTURE_2D, m_FrameBufferTexture[1]);
-    glActiveTexture(GL_TEXTURE0 + m_DepthTexture);
-    glBindTexture(GL_TEXTURE_2D, m_DepthTexture);
+    GLState::BindVertexArray(m_rectVAO);
+    GLState::BindTexture(m_FrameBufferTexture, m_FrameBufferTexture);
+    GLState::BindTexture(m_DepthTexture, m_DepthTexture);
+    GLState::BindTexture(m_BloomMip[0], m_BloomMip[0]);
     glDrawArrays(GL_TRIANGLES, 0, 6);
+    RenderStats::CountDraw(6);
 }
 
-void FrameBuffer::GaussianBlur(int amount, std::shared_ptr<Shader> blurShader) const
+void FrameBuffer::Bloom(std::shared_ptr<Shader> bloomShader) const
 {
-    bool horizontal = true, first_iteration = true;
-    blurShader->Bind();
-    for (unsigned int i = 0; i < amount; i++)
+    bloomShader->Bind();
+    UniformHandle upsampleUniform = bloomShader->GetUniform("upsample");
+    UniformHandle imageUniform = bloomShader->GetUniform("image");
+    UniformHandle brightPassUniform = bloomShader->GetUniform("brightPass");
+    GLState::BindVertexArray(m_rectVAO);
+
+    // Downsample: scene colour -> mip 0 (bright pass, half resolution) -> ... -> smallest mip
+    int mipWidth[BLOOM_MIPS], mipHeight[BLOOM_MIPS];
+    unsigned int source = m_FrameBufferTexture;
+    bloomShader->SetUniform1i(upsampleUniform, 0);
+    for (int i = 0; i < BLOOM_MIPS; i++)
     {
-        glBindFramebuffer(GL_FRAMEBUFFER, m_GaussianBlurFBO[horizontal]);
-        blurShader->SetUniform1i("horizontal", horizontal);
-        blurShader->SetUniform1i("image", first_iteration ? m_FrameBufferTexture[1] : m_GaussianBlurBuffer[!horizontal]);
-        glActiveTexture(GL_TEXTURE0 + m_GaussianBlurBuffer[!horizontal]);
-        glBindTexture(GL_TEXTURE_2D, first_iteration ? m_FrameBufferTexture[1] : m_GaussianBlurBuffer[!horizontal]);
-        glBindVertexArray(m_rectVAO);
+        bloomShader->SetUniform1i(brightPassUniform, i == 0);
+        mipWidth[i] = std::max((i == 0 ? m_Width : mipWidth[i - 1]) / 2, 1);
+        mipHeight[i] = std::max((i == 0 ? m_Height : mipHeight[i - 1]) / 2, 1);
+        GLState::BindFramebuffer(m_BloomFBO[i]);
+        glViewport(0, 0, mipWidth[i], mipHeight[i]);
+        bloomShader->SetUniform1i(imageUniform, source);
+        GLState::BindTexture(source, source);
         glDrawArrays(GL_TRIANGLES, 0, 6);
+        RenderStats::CountDraw(6);
+        source = m_BloomMip[i];
+    }
 
-        horizontal = !horizontal;
-        if (first_iteration)
-            first_iteration = false;
+    // Upsample: every level is filtered and added onto the next larger one, so mip 0 ends
+    // up with the sum of all of them
+    bloomShader->SetUniform1i(upsampleUniform, 1);
+    bloomShader->SetUniform1i(brightPassUniform, 0);
+    GLState::Enable(GL_BLEND);
+    glBlendFunc(GL_ONE, GL_ONE);
+    for (int i = BLOOM_MIPS - 1; i > 0; i--)
+    {
+        GLState::BindFramebuffer(m_BloomFBO[i - 1]);
+        glViewport(0, 0, mipWidth[i - 1], mipHeight[i - 1]);
+        bloomShader->SetUniform1i(imageUniform, m_BloomMip[i]);
+        GLState::BindTexture(m_BloomMip[i], m_BloomMip[i]);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        RenderStats::CountDraw(6);
     }
+    // Back to the blend function the scene uses (main.cpp)
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    glViewport(0, 0, m_Width, m_Height);
     Unbind();
 }
 
-void FrameBuffer::Resize(int width, int height) const
+void FrameBuffer::Resize(int width, int height)
 {
+    m_WindowWidth = width;
+    m_WindowHeight = height;
+    Allocate();
+}
+
+void FrameBuffer::SetRenderScale(float scale)
+{
+    int scaledWidth = std::max(static_cast<int>(m_WindowWidth * scale), 1);
+    int scaledHeight = std::max(static_cast<int>(m_WindowHeight * scale), 1);
+    m_RenderScale = scale;
+    if (scaledWidth == m_Width && scaledHeight == m_Height)
+        return;
+    Allocate();
+}
+
+void FrameBuffer::SetFormat(const FrameBufferFormat& format)
+{
+    if (format.color == m_Format.color && format.depth == m_Format.depth && format.bloom == m_Format.bloom)
+        return;
+    m_Format = format;
+    Allocate();
+}
+
+void FrameBuffer::Allocate()
+{
+    m_Width = std::max(static_cast<int>(m_WindowWidth * m_RenderScale), 1);
+    m_Height = std::max(static_cast<int>(m_WindowHeight * m_RenderScale), 1);
     // resize framebuffer texture
-    for (unsigned int i = 0; i < 2; i++)
+    GLState::BindTexture(0, m_FrameBufferTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, m_Format.color, m_Width, m_Height, 0, GL_RGB, GL_FLOAT, NULL);
+    // resize framebuffer depth texture
+    GLState::BindTexture(0, m_DepthTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, m_Format.depth, m_Width, m_Height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
+    // resize bloom mip chain
+    int mipWidth = m_Width, mipHeight = m_Height;
+    for (int i = 0; i < BLOOM_MIPS; i++)
     {
-        glBindTexture(GL_TEXTURE_2D, m_FrameBufferTexture[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
+        mipWidth = std::max(mipWidth / 2, 1);
+        mipHeight = std::max(mipHeight / 2, 1);
+        GLState::BindTexture(0, m_BloomMip[i]);
+        glTexImage2D(GL_TEXTURE_2D, 0, m_Format.bloom, mipWidth, mipHeight, 0, GL_RGB, GL_FLOAT, NULL);
     }
-    // resize framebuffer depth texture
-    glBindTexture(GL_TEXTURE_2D, m_DepthTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-    // resize Gaussian Blur buffer texture
-    for (GLuint i = 0; i < 2; i++)
+}
+
+static unsigned int BytesPerPixel(GLenum format)
+{
+    switch (format)
+    {
+    case GL_RGBA32F:              return 16;
+    case GL_RGB32F:               return 12;
+    case GL_RGBA16F:              return 8;
+    case GL_RGB16F:               return 6;
+    case GL_DEPTH_COMPONENT32F:   return 4;
+    case GL_DEPTH_COMPONENT16:    return 2;
+    default:                      return 4; // R11F_G11F_B10F, RGBA8, 24-bit depth (padded)
+    }
+}
+
+double FrameBuffer::GetMemoryBytes() const
+{
+    double bytes = double(m_Width) * m_Height * (BytesPerPixel(m_Format.color) + BytesPerPixel(m_Format.depth));
+    int mipWidth = m_Width, mipHeight = m_Height;
+    for (int i = 0; i < BLOOM_MIPS; i++)
+    {
+        mipWidth = std::max(mipWidth / 2, 1);
+        mipHeight = std::max(mipHeight / 2, 1);
+        bytes += double(mipWidth) * mipHeight * BytesPerPixel(m_Format.bloom);
+    }
+    return bytes;
+}
+
+double FrameBuffer::GetFrameTrafficBytes(bool bloom) const
+{
+    // Every pass touches each pixel of its targets once: no overdraw, caches or compression
+    double pixels = double(m_Width) * m_Height;
+    double color = BytesPerPixel(m_Format.color), depth = BytesPerPixel(m_Format.depth);
+    // Scene: colour write, depth test and write. Composite: colour and depth reads, RGBA8 window write
+    double bytes = pixels * (color + 2.0 * depth) + pixels * (color + depth)
+        + double(m_WindowWidth) * m_WindowHeight * 4.0;
+    if (!bloom)
+        return bytes;
+
+    double mipBytes[BLOOM_MIPS];
+    int mipWidth = m_Width, mipHeight = m_Height;
+    for (int i = 0; i < BLOOM_MIPS; i++)
     {
-        glBindTexture(GL_TEXTURE_2D, m_GaussianBlurBuffer[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, NULL);
+        mipWidth = std::max(mipWidth / 2, 1);
+        mipHeight = std::max(mipHeight / 2, 1);
+        mipBytes[i] = double(mipWidth) * mipHeight * BytesPerPixel(m_Format.bloom);
     }
+    // Downsample reads the larger level and writes the smaller one
+    bytes += pixels * color;
+    for (int i = 0; i < BLOOM_MIPS; i++)
+        bytes += mipBytes[i] + (i + 1 < BLOOM_MIPS ? mipBytes[i] : 0.0);
+    // Upsample reads the smaller level and blends into the larger one (read and write)
+    for (int i = BLOOM_MIPS - 1; i > 0; i--)
+        bytes += mipBytes[i] + 2.0 * mipBytes[i - 1];
+    // Composite reads mip 0
+    return bytes + mipBytes[0];
 }
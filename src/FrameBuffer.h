@@ -1,27 +1,60 @@
 #pragma once
 #include <memory>
+#include <GL/glew.h>
 #include "Shader.h"
 
+#define BLOOM_MIPS 6 // half resolution down to 1/64
+
+// Internal formats of the offscreen targets. The defaults are 4 bytes per pixel each;
+// GL_RGB16F and GL_DEPTH_COMPONENT32F restore the previous precision.
+struct FrameBufferFormat
+{
+	GLenum color = GL_R11F_G11F_B10F; // HDR scene colour, no alpha or sign needed
+	GLenum depth = GL_DEPTH_COMPONENT24;
+	GLenum bloom = GL_R11F_G11F_B10F;
+};
+
 class FrameBuffer
 {
 public:
-	FrameBuffer(int width, int height);
+	FrameBuffer(int width, int height, const FrameBufferFormat& format = FrameBufferFormat());
 	~FrameBuffer();
 
 	void Bind() const;
 	void Unbind() const;
-	void Render() const;
-	void GaussianBlur(int amount, std::shared_ptr<Shader> blurShader) const;
-	void Resize(int width, int height) const;
+	// Post-process into target, the window by default, at window size
+	void Render(unsigned int target = 0) const;
+	// Bright-pass the scene colour into mip 0 (half resolution), downsample it through the
+	// chain and upsample it back into mip 0
+	void Bloom(std::shared_ptr<Shader> bloomShader) const;
+	// Window size; the offscreen targets are this times the render scale
+	void Resize(int width, int height);
+	// Reallocates the offscreen targets when the scaled size changes, Render upscales to the window
+	void SetRenderScale(float scale);
+	void SetFormat(const FrameBufferFormat& format);
+
+	// Offscreen VRAM, and an estimate of the bytes moved per frame by the passes over these targets
+	double GetMemoryBytes() const;
+	double GetFrameTrafficBytes(bool bloom) const;
 
 	unsigned int GetID() { return m_RendererID; }
-	unsigned int* GetFBOTexture() { return m_FrameBufferTexture; }
-	unsigned int GetBlurTexture() { return m_GaussianBlurBuffer[1]; }
+	unsigned int GetFBOTexture() { return m_FrameBufferTexture; }
+	unsigned int GetBlurTexture() { return m_BloomMip[0]; }
 	unsigned int GetDepthTexture() { return m_DepthTexture; }
+	int GetWidth() const { return m_Width; }
+	int GetHeight() const { return m_Height; }
+	float GetRenderScale() const { return m_RenderScale; }
+
+private:
+	void Allocate();
 
 private:
+	int m_WindowWidth, m_WindowHeight;
+	float m_RenderScale;
+	int m_Width, m_Height; // scaled size of the offscreen targets
 	unsigned int m_RendererID;
-	unsigned int m_FrameBufferTexture[2], m_DepthTexture;
-	unsigned int m_GaussianBlurFBO[2], m_GaussianBlurBuffer[2];
+	FrameBufferFormat m_Format;
+	unsigned int m_FrameBufferTexture, m_DepthTexture;
+	unsigned int m_BloomFBO[BLOOM_MIPS], m_BloomMip[BLOOM_MIPS];
 	unsigned int m_rectVAO, m_rectVBO;
 };
\ No newline at end of file
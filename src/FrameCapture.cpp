@@ -0,0 +1,143 @@
+#include "FrameCapture.h"
+#include "Renderer.h"
+#include "GLState.h"
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+FrameCapture::FrameCapture()
+{
+    for (int i = 0; i < CAPTURE_PBO_COUNT; i++)
+        m_PendingFrame[i] = -1;
+}
+
+FrameCapture::~FrameCapture()
+{
+    Release();
+}
+
+void FrameCapture::Release()
+{
+    if (m_TargetFBO)
+    {
+        GLState::ForgetTexture(m_TargetTexture);
+        GLState::ForgetFramebuffer(m_TargetFBO);
+        glDeleteTextures(1, &m_TargetTexture);
+        glDeleteFramebuffers(1, &m_TargetFBO);
+        glDeleteBuffers(CAPTURE_PBO_COUNT, m_PBO);
+        m_TargetFBO = m_TargetTexture = 0;
+    }
+}
+
+void FrameCapture::Resize(int width, int height)
+{
+    if (width == m_Width && height == m_Height && m_TargetFBO)
+        return;
+
+    // Frames read at the old size are written before their buffers go away
+    Flush();
+    Release();
+    m_Width = width;
+    m_Height = height;
+
+    glGenTextures(1, &m_TargetTexture);
+    GLState::BindTexture(0, m_TargetTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    glGenFramebuffers(1, &m_TargetFBO);
+    GLState::BindFramebuffer(m_TargetFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_TargetTexture, 0);
+    auto fboStatus = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (fboStatus != GL_FRAMEBUFFER_COMPLETE)
+        std::cout << "Capture framebuffer error: " << fboStatus << '\n';
+
+    glGenBuffers(CAPTURE_PBO_COUNT, m_PBO);
+    for (int i = 0; i < CAPTURE_PBO_COUNT; i++)
+    {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBO[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, m_Width * m_Height * 4, NULL, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void FrameCapture::Capture(unsigned int framebuffer, unsigned int frame)
+{
+    if (!m_TargetFBO)
+        return;
+
+    // The slot about to be reused holds the oldest frame, which has had the longest to finish
+    if (m_PendingFrame[m_Next] >= 0)
+        Write(m_Next);
+
+    GLState::BindFramebuffer(framebuffer);
+    if (framebuffer == 0)
+    {
+        GLCall(glReadBuffer(GL_BACK));
+    }
+    GLCall(glPixelStorei(GL_PACK_ALIGNMENT, 4));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBO[m_Next]);
+    // With a pack buffer bound the last argument is an offset; the call only queues the copy
+    GLCall(glReadPixels(0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, (void*)0));
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_PendingFrame[m_Next] = static_cast<int>(frame);
+    m_Next = (m_Next + 1) % CAPTURE_PBO_COUNT;
+}
+
+void FrameCapture::Flush()
+{
+    // Oldest first
+    for (int i = 0; i < CAPTURE_PBO_COUNT; i++)
+    {
+        int slot = (m_Next + i) % CAPTURE_PBO_COUNT;
+        if (m_PendingFrame[slot] >= 0)
+            Write(slot);
+    }
+}
+
+void FrameCapture::Write(int slot)
+{
+    char filename[32];
+    std::snprintf(filename, sizeof(filename), "/frame_%05d.ppm", m_PendingFrame[slot]);
+    std::string filepath = m_Directory + filename;
+    m_PendingFrame[slot] = -1;
+
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_PBO[slot]);
+    const unsigned char* pixels = static_cast<const unsigned char*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_Width * m_Height * 4, GL_MAP_READ_BIT));
+    if (!pixels)
+    {
+        std::cout << "Failed to map capture buffer for " << filepath << std::endl;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return;
+    }
+
+    FILE* file = std::fopen(filepath.c_str(), "wb");
+    if (file)
+    {
+        std::fprintf(file, "P6\n%d %d\n255\n", m_Width, m_Height);
+        // GL rows start at the bottom, PPM rows at the top; alpha is dropped
+        std::vector<unsigned char> row(m_Width * 3);
+        for (int y = m_Height - 1; y >= 0; y--)
+        {
+            const unsigned char* src = pixels + y * m_Width * 4;
+            for (int x = 0; x < m_Width; x++)
+            {
+                row[x * 3 + 0] = src[x * 4 + 0];
+                row[x * 3 + 1] = src[x * 4 + 1];
+                row[x * 3 + 2] = src[x * 4 + 2];
+            }
+            std::fwrite(row.data(), 1, row.size(), file);
+        }
+        std::fclose(file);
+        m_Written++;
+    }
+    else
+        std::cout << "Failed to write " << filepath << std::endl;
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
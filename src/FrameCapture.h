@@ -0,0 +1,45 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <string>
+
+// Pixel buffers in flight; a frame is written to disk this many frames after it was read
+#define CAPTURE_PBO_COUNT 3
+
+// Reads finished frames back through a ring of pixel buffer objects and writes them as
+// binary PPM images (<directory>/frame_00000.ppm, ...). glReadPixels into a PBO returns
+// immediately, the copy is only mapped once the GPU is done with it, so capturing does
+// not stall the pipeline.
+// In headless mode the post-processed image is rendered into this object's own RGBA8
+// target instead of a window, see GetTarget().
+class FrameCapture
+{
+public:
+	FrameCapture();
+	~FrameCapture();
+
+	// Size of the captured frames; reallocates the target and the buffers when it changes
+	void Resize(int width, int height);
+	unsigned int GetTarget() const { return m_TargetFBO; }
+
+	void SetDirectory(const std::string& directory) { m_Directory = directory; }
+	// Start the readback of framebuffer (0: the window) as frame number frame
+	void Capture(unsigned int framebuffer, unsigned int frame);
+	// Write every frame still in flight
+	void Flush();
+
+	unsigned int GetWrittenCount() const { return m_Written; }
+
+private:
+	void Release();
+	void Write(int slot);
+
+private:
+	int m_Width = 0, m_Height = 0;
+	unsigned int m_TargetFBO = 0, m_TargetTexture = 0;
+	unsigned int m_PBO[CAPTURE_PBO_COUNT] = {};
+	int m_PendingFrame[CAPTURE_PBO_COUNT]; // -1: slot free
+	int m_Next = 0;
+	unsigned int m_Written = 0;
+	std::string m_Directory = ".";
+};
@@ -0,0 +1,108 @@
+#include "FrameTimings.h"
+#include "Renderer.h"
+
+#include <iostream>
+
+FrameTimings::FrameTimings()
+{
+}
+
+FrameTimings::~FrameTimings()
+{
+    Close();
+}
+
+bool FrameTimings::Open(const std::string& filepath)
+{
+    Close();
+    m_File = std::fopen(filepath.c_str(), "w");
+    if (!m_File)
+    {
+        std::cout << "Failed to write frame timings " << filepath << std::endl;
+        return false;
+    }
+    std::fprintf(m_File, "frame,time,cpu_ms,gpu_ms,x,y,z,draw_calls,triangles,program_binds,vao_binds,texture_binds,"
+        "uniform_uploads,buffer_bytes,chunks_visible,chunks_culled,shadow_chunk_draws,chunk_queue\n");
+    GLCall(glGenQueries(FRAME_TIMING_LATENCY * 2, &m_Queries[0][0]));
+    m_Frame = 0;
+    return true;
+}
+
+void FrameTimings::BeginFrame(float time, float x, float y, float z)
+{
+    if (!m_File)
+        return;
+
+    // The slot is reused, so the frame that last used it has to be written out first
+    PendingFrame& pending = m_Pending[m_Frame % FRAME_TIMING_LATENCY];
+    Resolve(pending, true);
+
+    pending.frame = m_Frame;
+    pending.time = time;
+    pending.x = x;
+    pending.y = y;
+    pending.z = z;
+    GLCall(glQueryCounter(m_Queries[m_Frame % FRAME_TIMING_LATENCY][0], GL_TIMESTAMP));
+    m_CpuStart = std::chrono::steady_clock::now();
+}
+
+void FrameTimings::EndFrame()
+{
+    if (!m_File)
+        return;
+
+    PendingFrame& pending = m_Pending[m_Frame % FRAME_TIMING_LATENCY];
+    pending.cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_CpuStart).count();
+    pending.stats = RenderStats::Get();
+    pending.waiting = true;
+    GLCall(glQueryCounter(m_Queries[m_Frame % FRAME_TIMING_LATENCY][1], GL_TIMESTAMP));
+    m_Frame++;
+
+    // Write whatever has finished meanwhile, oldest first
+    for (unsigned int i = 0; i < FRAME_TIMING_LATENCY; i++)
+    {
+        if (!Resolve(m_Pending[(m_Frame + i) % FRAME_TIMING_LATENCY], false))
+            break;
+    }
+}
+
+bool FrameTimings::Resolve(PendingFrame& pending, bool wait)
+{
+    if (!pending.waiting)
+        return true;
+
+    const unsigned int* queries = m_Queries[pending.frame % FRAME_TIMING_LATENCY];
+    if (!wait)
+    {
+        // The end timestamp completes last
+        GLint available = 0;
+        GLCall(glGetQueryObjectiv(queries[1], GL_QUERY_RESULT_AVAILABLE, &available));
+        if (!available)
+            return false;
+    }
+    GLuint64 start = 0, end = 0;
+    GLCall(glGetQueryObjectui64v(queries[0], GL_QUERY_RESULT, &start));
+    GLCall(glGetQueryObjectui64v(queries[1], GL_QUERY_RESULT, &end));
+    GLuint64 elapsed = end - start;
+
+    const RenderStatsCounters& stats = pending.stats;
+    std::fprintf(m_File, "%u,%.6f,%.4f,%.4f,%.3f,%.3f,%.3f,%u,%llu,%u,%u,%u,%u,%llu,%u,%u,%u,%u\n",
+        pending.frame, pending.time, pending.cpuMs, elapsed / 1e6, pending.x, pending.y, pending.z,
+        stats.drawCalls, stats.triangles, stats.programBinds, stats.vaoBinds, stats.textureBinds,
+        stats.uniformUploads, stats.bufferBytes, stats.chunksVisible, stats.chunksCulled, stats.shadowChunkDraws, stats.chunkQueue);
+    pending.waiting = false;
+    return true;
+}
+
+void FrameTimings::Close()
+{
+    if (!m_File)
+        return;
+
+    // Resolving in frame order keeps the rows sorted
+    for (unsigned int i = 0; i < FRAME_TIMING_LATENCY; i++)
+        Resolve(m_Pending[(m_Frame + i) % FRAME_TIMING_LATENCY], true);
+    GLCall(glDeleteQueries(FRAME_TIMING_LATENCY * 2, &m_Queries[0][0]));
+    std::fclose(m_File);
+    m_File = nullptr;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "RenderStats.h"
+
+// Frames a GPU timer query may stay in flight before its result is waited for
+#define FRAME_TIMING_LATENCY 4
+
+// Per-frame CPU and GPU time and the RenderStats counters written to a CSV file:
+//   frame,time,cpu_ms,gpu_ms,x,y,z,draw_calls,triangles,...
+// The GPU time is the difference of two GL_TIMESTAMP queries (core since 3.3), which unlike
+// GL_TIME_ELAPSED may enclose the Profiler's stage queries. Their results are read a few
+// frames late, so measuring never stalls the pipeline.
+class FrameTimings
+{
+public:
+	FrameTimings();
+	~FrameTimings();
+
+	bool Open(const std::string& filepath);
+	bool IsOpen() const { return m_File != nullptr; }
+
+	// Bracket everything the frame renders; time is the frame's (replay) time in seconds
+	void BeginFrame(float time, float x, float y, float z);
+	void EndFrame();
+	// Wait for the queries still in flight and close the file
+	void Close();
+
+private:
+	struct PendingFrame
+	{
+		unsigned int frame = 0;
+		float time = 0.0f;
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+		double cpuMs = 0.0;
+		RenderStatsCounters stats;
+		bool waiting = false;
+	};
+
+	// Write the row once the GPU time is known; false if it is not yet and wait is off
+	bool Resolve(PendingFrame& pending, bool wait);
+
+private:
+	FILE* m_File = nullptr;
+	unsigned int m_Queries[FRAME_TIMING_LATENCY][2] = {}; // start, end timestamp
+	PendingFrame m_Pending[FRAME_TIMING_LATENCY];
+	unsigned int m_Frame = 0;
+	std::chrono::steady_clock::time_point m_CpuStart;
+};
@@ -0,0 +1,210 @@
+#include "GLState.h"
+
+#include "Renderer.h"
+#include "RenderStats.h"
+
+// Initial values match the defaults of a freshly created context
+unsigned int GLState::m_Program = 0;
+unsigned int GLState::m_VertexArray = 0;
+unsigned int GLState::m_IndexBuffer = 0;
+unsigned int GLState::m_Framebuffer = 0;
+unsigned int GLState::m_ActiveUnit = 0;
+unsigned int GLState::m_Textures[GLState::MaxTextureUnits] = {};
+unsigned int GLState::m_Caps[GLState::CachedCapCount] = {};
+unsigned int GLState::m_CullFace = GL_BACK;
+unsigned int GLState::m_FrontFace = GL_CCW;
+unsigned int GLState::m_DepthFunc = GL_LESS;
+unsigned int GLState::m_DepthMask = GL_TRUE;
+GLStateStats GLState::m_Stats;
+
+bool GLState::Changed(unsigned int& cached, unsigned int value)
+{
+    if (cached == value)
+    {
+        m_Stats.suppressed++;
+        return false;
+    }
+    cached = value;
+    m_Stats.issued++;
+    return true;
+}
+
+int GLState::CapIndex(GLenum cap)
+{
+    switch (cap)
+    {
+    case GL_DEPTH_TEST:   return 0;
+    case GL_CULL_FACE:    return 1;
+    case GL_BLEND:        return 2;
+    case GL_SCISSOR_TEST: return 3;
+    default:              return -1;
+    }
+}
+
+void GLState::UseProgram(unsigned int program)
+{
+    if (Changed(m_Program, program))
+    {
+        GLCall(glUseProgram(program));
+        RenderStats::Get().programBinds++;
+    }
+}
+
+void GLState::BindVertexArray(unsigned int vao)
+{
+    if (Changed(m_VertexArray, vao))
+    {
+        GLCall(glBindVertexArray(vao));
+        RenderStats::Get().vaoBinds++;
+        // The element buffer binding belongs to the VAO
+        m_IndexBuffer = Unknown;
+    }
+}
+
+void GLState::BindIndexBuffer(unsigned int ibo)
+{
+    if (Changed(m_IndexBuffer, ibo))
+    {
+        GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo));
+    }
+}
+
+void GLState::BindFramebuffer(unsigned int fbo)
+{
+    if (Changed(m_Framebuffer, fbo))
+    {
+        GLCall(glBindFramebuffer(GL_FRAMEBUFFER, fbo));
+    }
+}
+
+void GLState::BindTexture(unsigned int unit, unsigned int texture)
+{
+    if (unit >= MaxTextureUnits)
+    {
+        m_ActiveUnit = unit;
+        m_Stats.issued += 2;
+        GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+        GLCall(glBindTexture(GL_TEXTURE_2D, texture));
+        RenderStats::Get().textureBinds++;
+        return;
+    }
+    // Even when the texture is already bound, callers may go on to edit "the bound texture"
+    if (Changed(m_ActiveUnit, unit))
+    {
+        GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+    }
+    if (m_Textures[unit] == texture)
+    {
+        m_Stats.suppressed++;
+        return;
+    }
+    m_Textures[unit] = texture;
+    m_Stats.issued++;
+    GLCall(glBindTexture(GL_TEXTURE_2D, texture));
+    RenderStats::Get().textureBinds++;
+}
+
+void GLState::Enable(GLenum cap)
+{
+    int index = CapIndex(cap);
+    if (index < 0)
+        m_Stats.issued++;
+    else if (!Changed(m_Caps[index], GL_TRUE))
+        return;
+    GLCall(glEnable(cap));
+}
+
+void GLState::Disable(GLenum cap)
+{
+    int index = CapIndex(cap);
+    if (index < 0)
+        m_Stats.issued++;
+    else if (!Changed(m_Caps[index], GL_FALSE))
+        return;
+    GLCall(glDisable(cap));
+}
+
+void GLState::CullFace(GLenum mode)
+{
+    if (Changed(m_CullFace, mode))
+    {
+        GLCall(glCullFace(mode));
+    }
+}
+
+void GLState::FrontFace(GLenum mode)
+{
+    if (Changed(m_FrontFace, mode))
+    {
+        GLCall(glFrontFace(mode));
+    }
+}
+
+void GLState::DepthFunc(GLenum func)
+{
+    if (Changed(m_DepthFunc, func))
+    {
+        GLCall(glDepthFunc(func));
+    }
+}
+
+void GLState::DepthMask(bool write)
+{
+    if (Changed(m_DepthMask, write ? GL_TRUE : GL_FALSE))
+    {
+        GLCall(glDepthMask(write ? GL_TRUE : GL_FALSE));
+    }
+}
+
+void GLState::ForgetProgram(unsigned int program)
+{
+    if (m_Program == program)
+        m_Program = Unknown;
+}
+
+void GLState::ForgetVertexArray(unsigned int vao)
+{
+    if (m_VertexArray == vao)
+    {
+        m_VertexArray = 0;
+        m_IndexBuffer = Unknown;
+    }
+}
+
+void GLState::ForgetIndexBuffer(unsigned int ibo)
+{
+    if (m_IndexBuffer == ibo)
+        m_IndexBuffer = Unknown;
+}
+
+void GLState::ForgetFramebuffer(unsigned int fbo)
+{
+    if (m_Framebuffer == fbo)
+        m_Framebuffer = 0;
+}
+
+void GLState::ForgetTexture(unsigned int texture)
+{
+    for (int i = 0; i < MaxTextureUnits; i++)
+    {
+        if (m_Textures[i] == texture)
+            m_Textures[i] = 0;
+    }
+}
+
+void GLState::Invalidate()
+{
+    m_Program = Unknown;
+    m_VertexArray = Unknown;
+    m_IndexBuffer = Unknown;
+    m_Framebuffer = Unknown;
+    m_ActiveUnit = Unknown;
+    for (int i = 0; i < MaxTextureUnits; i++)
+        m_Textures[i] = Unknown;
+    for (int i = 0; i < CachedCapCount; i++)
+        m_Caps[i] = Unknown;
+    m_CullFace = Unknown;
+    m_FrontFace = Unknown;
+    m_DepthFunc = Unknown;
+    m_DepthMask = Unknown;
+}
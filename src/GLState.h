@@ -0,0 +1,66 @@
+#pragma once
+
+#include <GL/glew.h>
+
+// Calls that reached the driver vs. calls dropped because the state was already set
+struct GLStateStats
+{
+	unsigned int issued = 0;
+	unsigned int suppressed = 0;
+};
+
+// Shadow copy of the bound GL state; redundant binds and toggles never reach the driver.
+// Everything that binds programs, VAOs, IBOs, textures or framebuffers must go through here,
+// otherwise call Invalidate() afterwards.
+class GLState
+{
+public:
+	static void UseProgram(unsigned int program);
+	static void BindVertexArray(unsigned int vao);
+	static void BindIndexBuffer(unsigned int ibo);
+	static void BindFramebuffer(unsigned int fbo);
+	static void BindTexture(unsigned int unit, unsigned int texture); // GL_TEXTURE_2D, leaves unit active
+
+	static void Enable(GLenum cap);
+	static void Disable(GLenum cap);
+	static void CullFace(GLenum mode);
+	static void FrontFace(GLenum mode);
+	static void DepthFunc(GLenum func);
+	static void DepthMask(bool write);
+
+	// Deleted objects may be unbound by GL and their names reused
+	static void ForgetProgram(unsigned int program);
+	static void ForgetVertexArray(unsigned int vao);
+	static void ForgetIndexBuffer(unsigned int ibo);
+	static void ForgetFramebuffer(unsigned int fbo);
+	static void ForgetTexture(unsigned int texture);
+
+	// Forget all cached state, e.g. after third-party code (ImGui) touched GL
+	static void Invalidate();
+
+	static const GLStateStats& GetFrameStats() { return m_Stats; }
+	static void ResetFrameStats() { m_Stats = GLStateStats(); }
+
+private:
+	static bool Changed(unsigned int& cached, unsigned int value);
+	static int CapIndex(GLenum cap);
+
+private:
+	static constexpr unsigned int Unknown = ~0u;
+	static constexpr int MaxTextureUnits = 32;
+	static constexpr int CachedCapCount = 4;
+
+	static unsigned int m_Program;
+	static unsigned int m_VertexArray;
+	static unsigned int m_IndexBuffer;
+	static unsigned int m_Framebuffer;
+	static unsigned int m_ActiveUnit;
+	static unsigned int m_Textures[MaxTextureUnits];
+	static unsigned int m_Caps[CachedCapCount];
+	static unsigned int m_CullFace;
+	static unsigned int m_FrontFace;
+	static unsigned int m_DepthFunc;
+	static unsigned int m_DepthMask;
+
+	static GLStateStats m_Stats;
+};
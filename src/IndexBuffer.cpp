@@ -1,26 +1,30 @@
 #include "IndexBuffer.h"
 
 #include "Renderer.h"
+#include "GLState.h"
+#include "RenderStats.h"
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
     : m_Count(count)
 {
     GLCall(glGenBuffers(1, &m_RendererID));
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+    GLState::BindIndexBuffer(m_RendererID);
     GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(unsigned int) * count, data, GL_STATIC_DRAW));
+    RenderStats::CountBufferBytes(sizeof(unsigned int) * count);
 }
 
 IndexBuffer::~IndexBuffer()
 {
+    GLState::ForgetIndexBuffer(m_RendererID);
     GLCall(glDeleteBuffers(1, &m_RendererID));
 }
 
 void IndexBuffer::Bind() const
 {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+    GLState::BindIndexBuffer(m_RendererID);
 }
 
 void IndexBuffer::Unbind() const
 {
-    GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+    GLState::BindIndexBuffer(0);
 }
@@ -0,0 +1,156 @@
+#include "Profiler.h"
+#include "Renderer.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <vector>
+
+#include "imgui.h"
+
+Profiler::Profiler()
+{
+    GLCall(glGenQueries(PROFILER_LATENCY * StageCount, &m_Queries[0][0]));
+}
+
+Profiler::~Profiler()
+{
+    GLCall(glDeleteQueries(PROFILER_LATENCY * StageCount, &m_Queries[0][0]));
+}
+
+const char* Profiler::GetStageName(ProfileStage stage)
+{
+    switch (stage)
+    {
+    case ProfileStage::WorldUpdate: return "World Update";
+    case ProfileStage::Shadow:      return "Shadow";
+    case ProfileStage::Opaque:      return "Opaque";
+    case ProfileStage::Water:       return "Water";
+    case ProfileStage::Blur:        return "Blur";
+    case ProfileStage::Composite:   return "Composite";
+    case ProfileStage::ImGui:       return "ImGui";
+    default:                        return "?";
+    }
+}
+
+void Profiler::BeginFrame()
+{
+    m_Frame++;
+    m_Slot = m_Frame % PROFILER_HISTORY;
+    for (int stage = 0; stage < StageCount; stage++)
+    {
+        // Stages skipped this frame show up as 0 CPU time; GPU time stays missing until resolved
+        m_Stats[stage].cpu[m_Slot] = 0.0f;
+        m_Stats[stage].gpu[m_Slot] = PROFILER_MISSING;
+    }
+
+    // This frame reuses the query set of PROFILER_LATENCY frames ago; read what it measured
+    int set = m_Frame % PROFILER_LATENCY;
+    for (int stage = 0; stage < StageCount; stage++)
+    {
+        if (!m_QueryIssued[set][stage])
+            continue;
+        GLint available = 0;
+        GLCall(glGetQueryObjectiv(m_Queries[set][stage], GL_QUERY_RESULT_AVAILABLE, &available));
+        if (available)
+        {
+            GLuint64 elapsed = 0;
+            GLCall(glGetQueryObjectui64v(m_Queries[set][stage], GL_QUERY_RESULT, &elapsed));
+            m_Stats[stage].gpu[m_QueryFrame[set][stage]] = float(elapsed / 1e6);
+        }
+        // Not done yet: the sample is dropped rather than waited for, and stays PROFILER_MISSING
+        m_QueryIssued[set][stage] = false;
+    }
+}
+
+void Profiler::Begin(ProfileStage stage)
+{
+    Trace::Begin(GetStageName(stage));
+    int set = m_Frame % PROFILER_LATENCY;
+    GLCall(glBeginQuery(GL_TIME_ELAPSED, m_Queries[set][int(stage)]));
+    m_CpuStart[int(stage)] = std::chrono::steady_clock::now();
+}
+
+void Profiler::End(ProfileStage stage)
+{
+    int set = m_Frame % PROFILER_LATENCY;
+    m_Stats[int(stage)].cpu[m_Slot] += std::chrono::duration<float, std::milli>(
+        std::chrono::steady_clock::now() - m_CpuStart[int(stage)]).count();
+    GLCall(glEndQuery(GL_TIME_ELAPSED));
+    m_QueryIssued[set][int(stage)] = true;
+    m_QueryFrame[set][int(stage)] = m_Slot;
+    Trace::End(GetStageName(stage));
+}
+
+// p-th percentile of the filled part of a history
+static float Percentile(std::vector<float> samples, float p)
+{
+    if (samples.empty())
+        return 0.0f;
+    size_t n = std::min(samples.size() - 1, size_t(p * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + n, samples.end());
+    return samples[n];
+}
+
+void Profiler::DrawPanel() const
+{
+    ImGui::Begin("Profiler");
+    int count = std::min(m_Frame, PROFILER_HISTORY);
+    // The slot of the current frame is still being filled; GPU times arrive PROFILER_LATENCY frames late
+    int first = m_Frame - count + 1;
+    ImGui::Text("Last %d frames, ms (GPU lags %d frames)", count, PROFILER_LATENCY);
+
+    if (ImGui::BeginTable("ProfilerStages", 7))
+    {
+        ImGui::TableSetupColumn("Stage");
+        ImGui::TableSetupColumn("CPU avg");
+        ImGui::TableSetupColumn("CPU p95");
+        ImGui::TableSetupColumn("GPU avg");
+        ImGui::TableSetupColumn("GPU p50");
+        ImGui::TableSetupColumn("GPU p95");
+        ImGui::TableSetupColumn("GPU p99");
+        ImGui::TableHeadersRow();
+        for (int stage = 0; stage < StageCount; stage++)
+        {
+            std::vector<float> cpu, gpu;
+            cpu.reserve(count);
+            gpu.reserve(count);
+            for (int frame = first; frame <= m_Frame - PROFILER_LATENCY; frame++)
+            {
+                cpu.push_back(m_Stats[stage].cpu[frame % PROFILER_HISTORY]);
+                float gpuTime = m_Stats[stage].gpu[frame % PROFILER_HISTORY];
+                if (gpuTime != PROFILER_MISSING)
+                    gpu.push_back(gpuTime);
+            }
+            float cpuAverage = 0.0f, gpuAverage = 0.0f;
+            for (size_t i = 0; i < cpu.size(); i++)
+                cpuAverage += cpu[i] / cpu.size();
+            for (size_t i = 0; i < gpu.size(); i++)
+                gpuAverage += gpu[i] / gpu.size();
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::Text("%s", GetStageName(ProfileStage(stage)));
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", cpuAverage);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", Percentile(cpu, 0.95f));
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", gpuAverage);
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", Percentile(gpu, 0.50f));
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", Percentile(gpu, 0.95f));
+            ImGui::TableNextColumn(); ImGui::Text("%.2f", Percentile(gpu, 0.99f));
+        }
+        ImGui::EndTable();
+    }
+
+    // Oldest sample on the left; missing GPU samples are below the 0 scale minimum and draw no bar
+    int offset = (m_Frame + 1) % PROFILER_HISTORY;
+    for (int stage = 0; stage < StageCount; stage++)
+    {
+        const char* name = GetStageName(ProfileStage(stage));
+        if (!ImGui::CollapsingHeader(name))
+            continue;
+        ImGui::PushID(stage);
+        ImGui::PlotHistogram("CPU", m_Stats[stage].cpu, PROFILER_HISTORY, offset, NULL, 0.0f, FLT_MAX, ImVec2(0, 50));
+        ImGui::PlotHistogram("GPU", m_Stats[stage].gpu, PROFILER_HISTORY, offset, NULL, 0.0f, FLT_MAX, ImVec2(0, 50));
+        ImGui::PopID();
+    }
+    ImGui::End();
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <chrono>
+
+// Frames kept for the histograms and percentiles
+#define PROFILER_HISTORY 240
+// Query sets per stage; results are read this many frames later, when they are long done.
+// Same depth as FRAME_TIMING_LATENCY.
+#define PROFILER_LATENCY 4
+// GPU history value of a frame whose query result never arrived
+#define PROFILER_MISSING -1.0f
+
+// Stages of a frame, in the order they run
+enum class ProfileStage {
+	WorldUpdate, Shadow, Opaque, Water, Blur, Composite, ImGui,
+	UNDIFINED
+};
+
+// Rolling timings of one stage in milliseconds, gpu may hold PROFILER_MISSING
+struct ProfileStats
+{
+	float cpu[PROFILER_HISTORY] = {};
+	float gpu[PROFILER_HISTORY] = {};
+};
+
+// CPU and GPU (GL_TIME_ELAPSED) time per frame stage. Stages must not overlap, timer
+// queries cannot nest. Each stage has PROFILER_LATENCY query objects used in turn, and
+// a result is only read when the query reports it available, so profiling never stalls.
+// Stages also show up as spans in the Trace.
+class Profiler
+{
+public:
+	Profiler();
+	~Profiler();
+
+	// Collect the finished queries of earlier frames and advance the history
+	void BeginFrame();
+	void Begin(ProfileStage stage);
+	void End(ProfileStage stage);
+
+	// Histograms and percentiles per stage
+	void DrawPanel() const;
+
+	const ProfileStats& GetStats(ProfileStage stage) const { return m_Stats[int(stage)]; }
+	static const char* GetStageName(ProfileStage stage);
+
+private:
+	static const int StageCount = int(ProfileStage::UNDIFINED);
+
+	ProfileStats m_Stats[StageCount];
+	unsigned int m_Queries[PROFILER_LATENCY][StageCount] = {};
+	bool m_QueryIssued[PROFILER_LATENCY][StageCount] = {};
+	int m_QueryFrame[PROFILER_LATENCY][StageCount] = {}; // history slot the result belongs to
+	std::chrono::steady_clock::time_point m_CpuStart[StageCount];
+	int m_Frame = 0;   // frames profiled so far
+	int m_Slot = 0;    // history slot of the current frame
+};
+
+// Times the enclosing block as one stage
+class ProfileScope
+{
+public:
+	ProfileScope(Profiler& profiler, ProfileStage stage) : m_Profiler(profiler), m_Stage(stage) { m_Profiler.Begin(m_Stage); }
+	~ProfileScope() { m_Profiler.End(m_Stage); }
+
+private:
+	Profiler& m_Profiler;
+	ProfileStage m_Stage;
+};
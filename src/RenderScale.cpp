@@ -0,0 +1,39 @@
+#include "RenderScale.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Frames to wait after a change, and the band around the target that counts as on target
+static const int CooldownFrames = 15;
+static const float Deadband = 0.1f;
+
+RenderScale::RenderScale(float targetFrameTime)
+    : m_TargetFrameTime(targetFrameTime), m_SmoothedFrameTime(targetFrameTime)
+{
+}
+
+float RenderScale::Update(float frameTime)
+{
+    // Exponential moving average; a hitch of a single frame barely moves it
+    m_SmoothedFrameTime += (frameTime - m_SmoothedFrameTime) * 0.1f;
+    if (m_Cooldown > 0)
+    {
+        m_Cooldown--;
+        return m_Scale;
+    }
+
+    float ratio = m_TargetFrameTime / m_SmoothedFrameTime;
+    if (std::abs(ratio - 1.0f) < Deadband)
+        return m_Scale;
+
+    // Pixel cost grows with the square of the scale
+    float scale = m_Scale * std::sqrt(ratio);
+    scale = std::round(scale / RENDER_SCALE_STEP) * RENDER_SCALE_STEP;
+    scale = std::min(std::max(scale, RENDER_SCALE_MIN), RENDER_SCALE_MAX);
+    if (scale != m_Scale)
+    {
+        m_Scale = scale;
+        m_Cooldown = CooldownFrames;
+    }
+    return m_Scale;
+}
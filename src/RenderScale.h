@@ -0,0 +1,29 @@
+#pragma once
+
+// Scale steps, so small frame time jitter does not reallocate the offscreen targets
+#define RENDER_SCALE_STEP 0.05f
+#define RENDER_SCALE_MIN 0.5f
+#define RENDER_SCALE_MAX 1.0f
+
+// Picks the resolution scale of the offscreen framebuffer so frames stay within a target time.
+// The frame time is smoothed, small deviations are ignored and after every change the new
+// scale gets a few frames to show its effect before the next one.
+class RenderScale
+{
+public:
+	RenderScale(float targetFrameTime);
+
+	// Feed the last frame time in seconds; returns the scale for the next frame
+	float Update(float frameTime);
+
+	void SetTargetFrameTime(float targetFrameTime) { m_TargetFrameTime = targetFrameTime; }
+	float GetTargetFrameTime() const { return m_TargetFrameTime; }
+	float GetScale() const { return m_Scale; }
+	float GetSmoothedFrameTime() const { return m_SmoothedFrameTime; }
+
+private:
+	float m_TargetFrameTime;
+	float m_Scale = RENDER_SCALE_MAX;
+	float m_SmoothedFrameTime = 0.0f;
+	int m_Cooldown = 0;
+};
@@ -0,0 +1,3 @@
+#include "RenderStats.h"
+
+RenderStatsCounters RenderStats::m_Frame;
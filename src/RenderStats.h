@@ -0,0 +1,40 @@
+#pragma once
+
+// What one frame asked of the driver. Binds count only the calls GLState let through.
+struct RenderStatsCounters
+{
+	unsigned int drawCalls = 0;
+	unsigned long long triangles = 0;    // submitted, before any culling on the GPU
+	unsigned int programBinds = 0;
+	unsigned int vaoBinds = 0;
+	unsigned int textureBinds = 0;
+	unsigned int uniformUploads = 0;     // glUniform* calls; UBO updates count as buffer bytes
+	unsigned long long bufferBytes = 0;  // vertex, index and uniform buffer uploads
+	unsigned int chunksVisible = 0;      // chunks in the camera view, drawn by the main passes
+	unsigned int chunksCulled = 0;       // chunks outside the camera view
+	unsigned int shadowChunkDraws = 0;   // chunk draws into the shadow cascades, summed over the cascades
+	unsigned int chunkQueue = 0;         // chunks waiting to be generated
+};
+
+// Per-frame counters, filled in by the draw, bind, uniform and buffer code.
+// Read them before ResetFrame() at the start of the next frame.
+class RenderStats
+{
+public:
+	static RenderStatsCounters& Get() { return m_Frame; }
+	static void ResetFrame() { m_Frame = RenderStatsCounters(); }
+
+	// A GL_TRIANGLES draw of count vertices/indices
+	static void CountDraw(unsigned int count, unsigned int instances = 1)
+	{
+		m_Frame.drawCalls++;
+		m_Frame.triangles += (unsigned long long)(count / 3) * instances;
+	}
+	// Once per chunk and frame, for the camera view
+	static void CountChunk(bool visible) { (visible ? m_Frame.chunksVisible : m_Frame.chunksCulled)++; }
+	static void CountShadowChunk() { m_Frame.shadowChunkDraws++; }
+	static void CountBufferBytes(unsigned long long bytes) { m_Frame.bufferBytes += bytes; }
+
+private:
+	static RenderStatsCounters m_Frame;
+};
@@ -1,7 +1,19 @@
 #include "Renderer.h"
+#include "GLState.h"
+#include "RenderStats.h"
+
+#include <algorithm>
 
 unsigned int Renderer::m_DepthMap = 0;
 unsigned int Renderer::m_DepthMapFBO = 0;
+bool Renderer::m_ShadowMoments = false;
+unsigned int Renderer::m_MomentsRawMap = 0;
+unsigned int Renderer::m_MomentsBlurMap = 0;
+unsigned int Renderer::m_MomentsMap = 0;
+unsigned int Renderer::m_MomentsBlurFBO = 0;
+unsigned int Renderer::m_MomentsFBO = 0;
+unsigned int Renderer::m_QuadVAO = 0;
+unsigned int Renderer::m_QuadVBO = 0;
 
 void GLClearError()
 {
@@ -19,6 +31,38 @@ bool GLLogCall(const char* function, const char* file, int line)
     return true;
 }
 
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_CALLBACK
+static void GLAPIENTRY GLDebugCallback(GLenum /*source*/, GLenum type, GLuint id, GLenum severity,
+    GLsizei /*length*/, const GLchar* message, const void* /*userParam*/)
+{
+    std::cout << "[OpenGL Debug] (" << id << ")"
+        << (type == GL_DEBUG_TYPE_ERROR ? " Error" : "")
+        << (severity == GL_DEBUG_SEVERITY_HIGH ? " [high]" : "") << "\n" << message << std::endl;
+#ifndef NDEBUG
+    // Output is synchronous in debug builds, so this stops inside the failing call
+    ASSERT(type != GL_DEBUG_TYPE_ERROR);
+#endif
+}
+#endif
+
+void InitGLDebugOutput()
+{
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_CALLBACK
+    if (!GLEW_KHR_debug && !GLEW_VERSION_4_3)
+    {
+        std::cout << "KHR_debug is not available, define GL_ERROR_CHECK=2 for glGetError checks" << std::endl;
+        return;
+    }
+    glEnable(GL_DEBUG_OUTPUT);
+#ifndef NDEBUG
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+#endif
+    glDebugMessageCallback(GLDebugCallback, nullptr);
+    // Notifications (buffer placement hints and the like) are noise
+    glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+#endif
+}
+
 Renderer::Renderer(std::vector<std::shared_ptr<Shader>> shader)
     :m_shader(shader)
 {
@@ -31,13 +75,13 @@ void Renderer::Clear() const
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 }
 
-void Renderer::Draw() const
+void Renderer::Draw(unsigned int faceMask) const
 {
-    glEnable(GL_DEPTH_TEST);
+    GLState::Enable(GL_DEPTH_TEST);
     // Back Face Culling
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
-    glFrontFace(GL_CW);
+    GLState::Enable(GL_CULL_FACE);
+    GLState::CullFace(GL_BACK);
+    GLState::FrontFace(GL_CW);
 
     for (int i = 0; i < (int)VAOType::UNDIFINED; i++)
     {
@@ -47,12 +91,49 @@ void Renderer::Draw() const
         switch (i)
         {
         case (int)VAOType::Solid:
-            GLCall(glDrawElements(GL_TRIANGLES, m_ib[i]->GetCount(), GL_UNSIGNED_INT, nullptr));
+            if (m_FaceRanges.empty())
+            {
+                GLCall(glDrawElements(GL_TRIANGLES, m_ib[i]->GetCount(), GL_UNSIGNED_INT, nullptr));
+                RenderStats::CountDraw(m_ib[i]->GetCount());
+            }
+            else
+            {
+                // Skip whole face buckets, merging neighbouring ranges into one sub-draw
+                GLsizei counts[(int)FaceDir::UNDIFINED];
+                const void* offsets[(int)FaceDir::UNDIFINED];
+                GLsizei drawCount = 0;
+                unsigned int lastEnd = 0;
+                unsigned int submitted = 0;
+                for (int f = 0; f < (int)FaceDir::UNDIFINED; f++)
+                {
+                    const IndexRange& range = m_FaceRanges[f];
+                    if (!(faceMask & (1u << f)) || range.count == 0)
+                        continue;
+                    if (drawCount > 0 && lastEnd == range.offset)
+                        counts[drawCount - 1] += range.count;
+                    else
+                    {
+                        counts[drawCount] = range.count;
+                        offsets[drawCount] = (const void*)(range.offset * sizeof(unsigned int));
+                        drawCount++;
+                    }
+                    lastEnd = range.offset + range.count;
+                    submitted += range.count;
+                }
+                if (drawCount > 0)
+                {
+                    GLCall(glMultiDrawElements(GL_TRIANGLES, counts, GL_UNSIGNED_INT, offsets, drawCount));
+                    RenderStats::CountDraw(submitted);
+                }
+            }
             break;
         case (int)VAOType::Billboard:
-            glDisable(GL_CULL_FACE);
-            GLCall(glDrawElements(GL_TRIANGLES, m_ib[i]->GetCount(), GL_UNSIGNED_INT, nullptr));
-            glEnable(GL_CULL_FACE);
+            if (m_BillboardInstances == 0)
+                break;
+            GLState::Disable(GL_CULL_FACE);
+            GLCall(glDrawElementsInstanced(GL_TRIANGLES, m_ib[i]->GetCount(), GL_UNSIGNED_INT, nullptr, m_BillboardInstances));
+            RenderStats::CountDraw(m_ib[i]->GetCount(), m_BillboardInstances);
+            GLState::Enable(GL_CULL_FACE);
             break;
         default:
             break;
@@ -60,15 +141,100 @@ void Renderer::Draw() const
     }
 }
 
-void Renderer::DrawWater() const
+void Renderer::DrawWater(std::vector<std::shared_ptr<Renderer>> renderers, const glm::vec3& cameraPos)
+{
+    const int i = (int)VAOType::Water;
+    renderers.erase(std::remove_if(renderers.begin(), renderers.end(),
+        [](const std::shared_ptr<Renderer>& r) { return r->m_ib[(int)VAOType::Water]->GetCount() == 0; }), renderers.end());
+    if (renderers.empty())
+        return;
+
+    std::vector<std::pair<float, Renderer*>> sorted;
+    sorted.reserve(renderers.size());
+    for (const auto& r : renderers)
+    {
+        glm::vec3 offset = (r->m_BoundsMin + r->m_BoundsMax) * 0.5f - cameraPos;
+        sorted.push_back({ glm::dot(offset, offset), r.get() });
+    }
+    std::sort(sorted.begin(), sorted.end(),
+        [](const std::pair<float, Renderer*>& a, const std::pair<float, Renderer*>& b) { return a.first > b.first; });
+
+    GLState::Disable(GL_CULL_FACE);
+    sorted.front().second->m_shader[i]->Bind();
+    for (const auto& entry : sorted)
+    {
+        const Renderer* r = entry.second;
+        r->m_va[i]->Bind();
+        r->m_ib[i]->Bind();
+        GLCall(glDrawElements(GL_TRIANGLES, r->m_ib[i]->GetCount(), GL_UNSIGNED_INT, nullptr));
+        RenderStats::CountDraw(r->m_ib[i]->GetCount());
+    }
+    GLState::Enable(GL_CULL_FACE);
+}
+
+void Renderer::SortFrontToBack(std::vector<std::shared_ptr<Renderer>>& renderers, const glm::vec3& cameraPos)
+{
+    std::vector<std::pair<float, std::shared_ptr<Renderer>>> sorted;
+    sorted.reserve(renderers.size());
+    for (const auto& r : renderers)
+    {
+        // The chunk the camera is in has distance 0 and goes first
+        glm::vec3 offset = glm::clamp(cameraPos, r->m_BoundsMin, r->m_BoundsMax) - cameraPos;
+        sorted.push_back({ glm::dot(offset, offset), r });
+    }
+    std::sort(sorted.begin(), sorted.end(),
+        [](const std::pair<float, std::shared_ptr<Renderer>>& a, const std::pair<float, std::shared_ptr<Renderer>>& b) { return a.first < b.first; });
+    for (size_t i = 0; i < sorted.size(); i++)
+        renderers[i] = sorted[i].second;
+}
+
+unsigned int Renderer::FacesTowards(const glm::vec3& viewPos) const
+{
+    // A face bucket is back-facing for every face in it once the viewer is
+    // behind the nearest possible plane of that bucket inside the AABB
+    unsigned int mask = 0;
+    if (viewPos.x > m_BoundsMin.x) mask |= 1u << (int)FaceDir::PosX;
+    if (viewPos.x < m_BoundsMax.x) mask |= 1u << (int)FaceDir::NegX;
+    if (viewPos.y > m_BoundsMin.y) mask |= 1u << (int)FaceDir::PosY;
+    if (viewPos.y < m_BoundsMax.y) mask |= 1u << (int)FaceDir::NegY;
+    if (viewPos.z > m_BoundsMin.z) mask |= 1u << (int)FaceDir::PosZ;
+    if (viewPos.z < m_BoundsMax.z) mask |= 1u << (int)FaceDir::NegZ;
+    return mask;
+}
+
+bool Renderer::InView(const glm::mat4& viewProj) const
+{
+    // One block of margin for water waves and plants on the top layer
+    glm::vec3 boundsMin = m_BoundsMin - 1.0f, boundsMax = m_BoundsMax + 1.0f;
+    // Out of view only when all eight corners are beyond the same clip plane
+    unsigned int outside = 0x3f;
+    for (int corner = 0; corner < 8; corner++)
+    {
+        glm::vec4 p = viewProj * glm::vec4(corner & 1 ? boundsMax.x : boundsMin.x,
+            corner & 2 ? boundsMax.y : boundsMin.y, corner & 4 ? boundsMax.z : boundsMin.z, 1.0f);
+        unsigned int planes = 0;
+        if (p.x < -p.w) planes |= 1u;
+        if (p.x > p.w)  planes |= 2u;
+        if (p.y < -p.w) planes |= 4u;
+        if (p.y > p.w)  planes |= 8u;
+        if (p.z < -p.w) planes |= 16u;
+        if (p.z > p.w)  planes |= 32u;
+        outside &= planes;
+    }
+    return outside == 0;
+}
+
+unsigned int Renderer::FacesTowardsDirection(const glm::vec3& viewDir)
 {
-    glDisable(GL_CULL_FACE);
-    int i = (int)VAOType::Water;
-    m_shader[i]->Bind();
-    m_va[i]->Bind();
-    m_ib[i]->Bind();
-    GLCall(glDrawElements(GL_TRIANGLES, m_ib[i]->GetCount(), GL_UNSIGNED_INT, nullptr));
-    glEnable(GL_CULL_FACE);
+    // Orthographic viewer: only faces whose normal points against viewDir are front-facing
+    unsigned int mask = 0;
+    if (viewDir.x < 0.0f) mask |= 1u << (int)FaceDir::PosX;
+    if (viewDir.x > 0.0f) mask |= 1u << (int)FaceDir::NegX;
+    if (viewDir.y < 0.0f) mask |= 1u << (int)FaceDir::PosY;
+    if (viewDir.y > 0.0f) mask |= 1u << (int)FaceDir::NegY;
+    if (viewDir.z < 0.0f) mask |= 1u << (int)FaceDir::PosZ;
+    if (viewDir.z > 0.0f) mask |= 1u << (int)FaceDir::NegZ;
+    return mask;
 }
 
 void Renderer::SetVAOIBO(std::vector<std::shared_ptr<VertexArray>> va, std::vector<std::shared_ptr<IndexBuffer>> ib)
@@ -83,6 +249,14 @@ void Renderer::SetVAOIBO(std::vector<std::shared_ptr<VertexArray>> va, std::vect
     }
 }
 
+void Renderer::SetFaceRanges(const std::vector<IndexRange>& ranges, glm::vec3 boundsMin, glm::vec3 boundsMax)
+{
+    assert(ranges.size() == (int)FaceDir::UNDIFINED);
+    m_FaceRanges = ranges;
+    m_BoundsMin = boundsMin;
+    m_BoundsMax = boundsMax;
+}
+
 void Renderer::ChangeShader(std::shared_ptr<Shader> shader)
 {
     for (int i = 0; i < m_shader.size(); i++)
@@ -103,7 +277,7 @@ void Renderer::GenerateDepthMap()
 
     glGenFramebuffers(1, &m_DepthMapFBO);
     glGenTextures(1, &m_DepthMap);
-    glBindTexture(GL_TEXTURE_2D, m_DepthMap);
+    GLState::BindTexture(0, m_DepthMap);
     glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, 
         SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
@@ -111,9 +285,126 @@ void Renderer::GenerateDepthMap()
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, m_DepthMapFBO);
+    GLState::BindFramebuffer(m_DepthMapFBO);
     glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_DepthMap, 0);
     glDrawBuffer(GL_NONE);
     glReadBuffer(GL_NONE);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    GLState::BindFramebuffer(0);
+}
+
+void Renderer::BeginShadowCascade(int cascade, int x, int y, int width, int height)
+{
+    int tileX = (cascade % 2) * SHADOW_CASCADE_SIZE;
+    int tileY = (cascade / 2) * SHADOW_CASCADE_SIZE;
+    GLState::BindFramebuffer(m_DepthMapFBO);
+    glViewport(tileX, tileY, SHADOW_CASCADE_SIZE, SHADOW_CASCADE_SIZE);
+    glScissor(tileX + x, tileY + y, width, height);
+    GLState::Enable(GL_SCISSOR_TEST);
+    glClear(GL_DEPTH_BUFFER_BIT);
+    if (m_ShadowMoments)
+    {
+        // Moments of the far plane
+        const float farMoments[4] = { 1.0f, 1.0f, 0.0f, 0.0f };
+        glClearBufferfv(GL_COLOR, 0, farMoments);
+    }
+}
+
+void Renderer::EndShadowPass()
+{
+    GLState::Disable(GL_SCISSOR_TEST);
+}
+
+void Renderer::SetShadowMoments(bool enable)
+{
+    if (enable && m_MomentsMap == 0)
+    {
+        unsigned int* maps[3] = { &m_MomentsRawMap, &m_MomentsBlurMap, &m_MomentsMap };
+        for (unsigned int* map : maps)
+        {
+            glGenTextures(1, map);
+            GLState::BindTexture(0, *map);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32F, SHADOW_WIDTH, SHADOW_HEIGHT, 0, GL_RG, GL_FLOAT, NULL);
+            // Moments are filtered, that's the point of VSM
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        }
+
+        GLState::BindFramebuffer(m_DepthMapFBO);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_MomentsRawMap, 0);
+        unsigned int* fbos[2] = { &m_MomentsBlurFBO, &m_MomentsFBO };
+        unsigned int targets[2] = { m_MomentsBlurMap, m_MomentsMap };
+        for (int i = 0; i < 2; i++)
+        {
+            glGenFramebuffers(1, fbos[i]);
+            GLState::BindFramebuffer(*fbos[i]);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, targets[i], 0);
+            if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+                std::cout << "ERROR::FRAMEBUFFER:: Moments framebuffer is not complete!" << std::endl;
+        }
+
+        float quadVertices[] = {
+            // Coords    // texCoords
+             1.0f, -1.0f,  1.0f, 0.0f,
+            -1.0f, -1.0f,  0.0f, 0.0f,
+            -1.0f,  1.0f,  0.0f, 1.0f,
+
+             1.0f,  1.0f,  1.0f, 1.0f,
+             1.0f, -1.0f,  1.0f, 0.0f,
+            -1.0f,  1.0f,  0.0f, 1.0f
+        };
+        glGenVertexArrays(1, &m_QuadVAO);
+        glGenBuffers(1, &m_QuadVBO);
+        GLState::BindVertexArray(m_QuadVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, m_QuadVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(quadVertices), &quadVertices, GL_STATIC_DRAW);
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)0);
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(float), (void*)(2 * sizeof(float)));
+    }
+    if (m_MomentsMap == 0)
+        return;
+
+    m_ShadowMoments = enable;
+    GLState::BindFramebuffer(m_DepthMapFBO);
+    glDrawBuffer(enable ? GL_COLOR_ATTACHMENT0 : GL_NONE);
+}
+
+void Renderer::BlurShadowMoments(std::shared_ptr<Shader> blurShader, int cascade, int x, int y, int width, int height)
+{
+    // Both passes read unblurred input, so redoing a grown region never blurs twice.
+    // Grow by the kernel radius: texels next to the changed ones pick up new values too
+    const int radius = 4;
+    int x0 = std::max(x - radius, 0), y0 = std::max(y - radius, 0);
+    int x1 = std::min(x + width + radius, SHADOW_CASCADE_SIZE), y1 = std::min(y + height + radius, SHADOW_CASCADE_SIZE);
+    int tileX = (cascade % 2) * SHADOW_CASCADE_SIZE;
+    int tileY = (cascade / 2) * SHADOW_CASCADE_SIZE;
+
+    // The quad covers the whole atlas texel for texel; the scissor limits it to the region
+    GLState::Disable(GL_DEPTH_TEST);
+    GLState::Enable(GL_SCISSOR_TEST);
+    glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
+    glScissor(tileX + x0, tileY + y0, x1 - x0, y1 - y0);
+
+    blurShader->Bind();
+    UniformHandle horizontalUniform = blurShader->GetUniform("horizontal");
+    UniformHandle imageUniform = blurShader->GetUniform("image");
+    blurShader->SetUniform1i(imageUniform, 0);
+    GLState::BindVertexArray(m_QuadVAO);
+
+    GLState::BindFramebuffer(m_MomentsBlurFBO);
+    GLState::BindTexture(0, m_MomentsRawMap);
+    blurShader->SetUniform1i(horizontalUniform, 1);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    RenderStats::CountDraw(6);
+
+    GLState::BindFramebuffer(m_MomentsFBO);
+    GLState::BindTexture(0, m_MomentsBlurMap);
+    blurShader->SetUniform1i(horizontalUniform, 0);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    RenderStats::CountDraw(6);
+
+    GLState::Enable(GL_DEPTH_TEST);
 }
@@ -2,19 +2,51 @@
 
 #include <GL/glew.h>
 
+#include "ChunkMesher.h" // FaceDir, IndexRange
 #include "IndexBuffer.h"
 #include "VertexArray.h"
 #include "Shader.h"
 #include <iostream>
+#include <csignal>
 
-#define ASSERT(x) if(!(x)) __debugbreak();
+#if defined(_MSC_VER)
+#define DEBUG_BREAK() __debugbreak()
+#elif defined(SIGTRAP)
+#define DEBUG_BREAK() raise(SIGTRAP)
+#else
+#define DEBUG_BREAK() __builtin_trap()
+#endif
+#define ASSERT(x) if(!(x)) DEBUG_BREAK();
+
+// GL error checking level, override with a preprocessor definition:
+// OFF      - nothing
+// CALLBACK - KHR_debug reports errors from the driver, GLCall costs nothing (default)
+// SYNC     - glGetError around every GLCall, for drivers without KHR_debug
+#define GL_ERROR_CHECK_OFF 0
+#define GL_ERROR_CHECK_CALLBACK 1
+#define GL_ERROR_CHECK_SYNC 2
+#ifndef GL_ERROR_CHECK
+#define GL_ERROR_CHECK GL_ERROR_CHECK_CALLBACK
+#endif
+
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_SYNC
 #define GLCall(x) GLClearError(); x; ASSERT(GLLogCall(#x, __FILE__, __LINE__));
+#else
+#define GLCall(x) x;
+#endif
 
 void GLClearError();
 bool GLLogCall(const char* function, const char* file, int line);
+// Hook KHR_debug output up when GL_ERROR_CHECK is CALLBACK; call once after glewInit()
+void InitGLDebugOutput();
 
 #define SHADOW_WIDTH 2048
 #define SHADOW_HEIGHT 2048
+// The depth map is a 2x2 atlas with one SHADOW_CASCADE_SIZE tile per cascade
+#define SHADOW_CASCADES 4
+#define SHADOW_CASCADE_SIZE 1024
+// Poisson taps of the PCF filter, and of the PCSS blocker search and filter each
+#define SHADOW_FILTER_SAMPLES 50
 
 // VAO Type
 enum class VAOType {
@@ -29,9 +61,26 @@ class Renderer
 public:
 	Renderer(std::vector<std::shared_ptr<Shader>> shader);
 
+	static constexpr unsigned int AllFaces = (1u << (int)FaceDir::UNDIFINED) - 1;
+
 	void Clear() const;
-	void Draw() const;
-	void DrawWater() const;
+	void Draw(unsigned int faceMask = AllFaces) const;
+	// Water of all given chunks, sorted back to front for blending. Shader and cull state are set
+	// once, but each chunk is still its own draw: the water lives in per-chunk buffers
+	static void DrawWater(std::vector<std::shared_ptr<Renderer>> renderers, const glm::vec3& cameraPos);
+	// Nearest first by distance from the camera to the chunk AABB, so early-Z rejects hidden fragments
+	static void SortFrontToBack(std::vector<std::shared_ptr<Renderer>>& renderers, const glm::vec3& cameraPos);
+
+	// Face buckets that can face a viewer at viewPos, given the chunk AABB
+	unsigned int FacesTowards(const glm::vec3& viewPos) const;
+	// Face buckets that can face a directional viewer (e.g. the sun) looking along viewDir
+	static unsigned int FacesTowardsDirection(const glm::vec3& viewDir);
+
+	// Whether the chunk AABB may reach into the clip volume of viewProj; conservative
+	bool InView(const glm::mat4& viewProj) const;
+
+	const glm::vec3& GetBoundsMin() const { return m_BoundsMin; }
+	const glm::vec3& GetBoundsMax() const { return m_BoundsMax; }
 	
 	//std::vector<std::shared_ptr<VertexArray>> GetVAO() const { return m_va; };
 	//std::vector<std::shared_ptr<IndexBuffer>> GetIBO() const { return m_ib; };
@@ -39,20 +88,40 @@ public:
 
 	static unsigned int GetDepthMap() { return m_DepthMap; };
 	static unsigned int GetDepthMapFBO() { return m_DepthMapFBO; };
+	static unsigned int GetMomentsMap() { return m_MomentsMap; };
 
 	void SetVAOIBO(std::vector<std::shared_ptr<VertexArray>> va, std::vector<std::shared_ptr<IndexBuffer>> ib);
+	void SetFaceRanges(const std::vector<IndexRange>& ranges, glm::vec3 boundsMin, glm::vec3 boundsMax);
+	void SetBillboardInstances(unsigned int count) { m_BillboardInstances = count; }
 	void ChangeShader(std::shared_ptr<Shader> shader);
 	void ChangeShader(std::vector<std::shared_ptr<Shader>> shaders);
 
 	void GenerateDepthMap();
+	// Bind the depth map, set the viewport to the tile of one cascade and clear (and
+	// restrict drawing to) the given tile-local rectangle
+	static void BeginShadowCascade(int cascade, int x, int y, int width, int height);
+	static void EndShadowPass();
+	// VSM: the shadow pass also writes depth moments into an RG32F map (allocated on first use)
+	static void SetShadowMoments(bool enable);
+	// Separable blur of the moments inside a tile-local rectangle of one cascade
+	static void BlurShadowMoments(std::shared_ptr<Shader> blurShader, int cascade, int x, int y, int width, int height);
 	
 private:
 	std::vector<std::shared_ptr<VertexArray>> m_va;
 	std::vector<std::shared_ptr<IndexBuffer>> m_ib;
 	std::vector<std::shared_ptr<Shader>> m_shader;
 
+	std::vector<IndexRange> m_FaceRanges;
+	glm::vec3 m_BoundsMin{ 0.0f }, m_BoundsMax{ 0.0f };
+	unsigned int m_BillboardInstances = 0;
+
 	static unsigned int m_DepthMap;
 	static unsigned int m_DepthMapFBO;
+	static bool m_ShadowMoments;
+	// Raw moments from the shadow pass, horizontal blur and final blurred moments
+	static unsigned int m_MomentsRawMap, m_MomentsBlurMap, m_MomentsMap;
+	static unsigned int m_MomentsBlurFBO, m_MomentsFBO;
+	static unsigned int m_QuadVAO, m_QuadVBO;
 };
 
 
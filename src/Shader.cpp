@@ -1,32 +1,116 @@
 #include "Shader.h"
 
+#include <cassert>
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <stdexcept>
+#include <vector>
+#ifdef _WIN32
+#include <direct.h>
+#define MAKE_DIRECTORY(path) _mkdir(path)
+#else
+#include <sys/stat.h>
+#define MAKE_DIRECTORY(path) mkdir(path, 0755)
+#endif
 
 #include "Renderer.h"
+#include "FrameBuffer.h"
+#include "GLState.h"
+#include "RenderStats.h"
 
+#define SHADER_CACHE_DIRECTORY "shadercache"
 
-Shader::Shader(const std::string& filepath)
-    :m_FilePath(filepath), m_RendererID(0)
+// FNV-1a, good enough to tell sources and drivers apart
+static unsigned long long HashString(const std::string& text, unsigned long long hash = 14695981039346656037ull)
+{
+    for (unsigned char c : text)
+    {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Engine constants injected into every stage ahead of the variant defines,
+// so shaders use the same values as the C++ side
+static const std::vector<std::string>& EngineDefines()
+{
+    static const std::vector<std::string> defines = {
+        "SHADOW_CASCADES " + std::to_string(SHADOW_CASCADES),
+        "BLOOM_MIPS " + std::to_string(BLOOM_MIPS),
+        "SHADOW_FILTER_SAMPLES " + std::to_string(SHADOW_FILTER_SAMPLES),
+    };
+    return defines;
+}
+
+// Paste the file named by an #include "name" line, relative to the including shader
+static void AppendInclude(std::stringstream& out, const std::string& directory, const std::string& line)
+{
+    size_t first = line.find('"');
+    size_t last = line.rfind('"');
+    if (first == std::string::npos || last == first)
+        throw std::runtime_error("Malformed shader include: " + line);
+    std::ifstream stream(directory + line.substr(first + 1, last - first - 1));
+    if (!stream.is_open())
+        throw std::runtime_error("Failed to open shader include: " + line);
+    out << stream.rdbuf() << "\n";
+}
+
+static bool ProgramBinarySupported()
+{
+    if (!GLEW_ARB_get_program_binary)
+        return false;
+    int formats = 0;
+    GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+    return formats > 0;
+}
+
+Shader::Shader(const std::string& filepath, const std::vector<std::string>& defines)
+    :m_FilePath(filepath), m_Defines(defines), m_RendererID(0)
 {
     ShaderProgramSource source = ParseShader(filepath);
     //std::string vertexShader = source.vertexSource;
     //std::string fragmentShader = source.fragmentSource;
     //std::cout << "\nVertex Shader:\n" << vertexShader << std::endl;
     //std::cout << "\nFragment Shader:\n" << fragmentShader << std::endl;
-    m_RendererID = CreateShader(source.vertexSource, source.geometrySource, source.fragmentSource);
 
+    if (ProgramBinarySupported())
+    {
+        // A driver update invalidates every binary, so the driver is part of the key
+        std::string driver = std::string((const char*)glGetString(GL_VENDOR)) + "|"
+            + (const char*)glGetString(GL_RENDERER) + "|" + (const char*)glGetString(GL_VERSION);
+        unsigned long long key = HashString(driver);
+        key = HashString(source.vertexSource, key);
+        key = HashString(source.geometrySource, key);
+        key = HashString(source.fragmentSource, key);
+        std::stringstream path;
+        path << SHADER_CACHE_DIRECTORY << "/" << std::hex << key << ".bin";
+        m_CachePath = path.str();
+
+        m_RendererID = LoadProgramBinary();
+    }
+    if (m_RendererID == 0)
+    {
+        m_RendererID = CreateShader(source.vertexSource, source.geometrySource, source.fragmentSource);
+        m_SaveBinary = !m_CachePath.empty();
+    }
 }
 
 Shader::~Shader()
 {
+    // Stages of a program that was never used are still waiting for Finalize()
+    for (unsigned int id : m_PendingShaders)
+    {
+        GLCall(glDeleteShader(id));
+    }
+    GLState::ForgetProgram(m_RendererID);
     GLCall(glDeleteProgram(m_RendererID));
 }
 
 ShaderProgramSource Shader::ParseShader(const std::string& filepath)
 {
-    std::fstream stream(m_FilePath);
+    std::fstream stream(filepath);
 
     if (!stream.is_open()) {
         throw std::runtime_error("Failed to open shader file.");
@@ -37,6 +121,9 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
         NONE = -1, VERTEX = 0, GEOMETRY = 1, FRAGMENT = 2
     };
 
+    size_t slash = filepath.find_last_of("/\\");
+    std::string directory = slash == std::string::npos ? "" : filepath.substr(0, slash + 1);
+
     std::string line;
     std::stringstream ss[3];
     ShaderType type = ShaderType::NONE;
@@ -51,9 +138,21 @@ ShaderProgramSource Shader::ParseShader(const std::string& filepath)
             else if (line.find("fragment") != std::string::npos)
                 type = ShaderType::FRAGMENT;
         }
+        else if (type != ShaderType::NONE && line.compare(0, 8, "#include") == 0)
+        {
+            AppendInclude(ss[(int)type], directory, line);
+        }
         else if (type != ShaderType::NONE)// read string
         {
             ss[(int)type] << line << "\n";
+            // Engine and variant defines have to follow #version
+            if (line.find("#version") != std::string::npos)
+            {
+                for (const std::string& define : EngineDefines())
+                    ss[(int)type] << "#define " << define << "\n";
+                for (const std::string& define : m_Defines)
+                    ss[(int)type] << "#define " << define << "\n";
+            }
         }
     }
 
@@ -67,22 +166,8 @@ unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
     glShaderSource(id, 1, &src, nullptr);
     glCompileShader(id);
 
-    //Error handling
-    int result;
-    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
-    if (result == GL_FALSE)
-    {
-        int length;
-        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
-        char* message = (char*)alloca(length * sizeof(char)); // on stack
-        glGetShaderInfoLog(id, length, &length, message);
-        std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : 
-            (type == GL_FRAGMENT_SHADER ? "fragment" : "geometry")) << " shader!" << std::endl;
-        std::cout << message << std::endl;
-        glDeleteShader(id);
-        return 0;
-    }
-
+    // Error handling is deferred to Finalize()
+    m_PendingShaders.push_back(id);
     return id;
 }
 
@@ -100,65 +185,253 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
         glAttachShader(program, gs);
     }
     glAttachShader(program, fs);
+    if (GLEW_ARB_get_program_binary)
+        glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(program);
-    glValidateProgram(program);
 
-    glDeleteShader(vs);
-    if (geometryShader != "")
-        glDeleteShader(gs);
-    glDeleteShader(fs);
+    return program;
 
+}
+
+unsigned int Shader::LoadProgramBinary() const
+{
+    std::ifstream file(m_CachePath, std::ios::binary);
+    if (!file.is_open())
+        return 0;
+
+    GLenum format = 0;
+    if (!file.read((char*)&format, sizeof(format)))
+        return 0;
+    std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (binary.empty())
+        return 0;
+
+    unsigned int program = glCreateProgram();
+    glProgramBinary(program, format, binary.data(), (int)binary.size());
+    // A stale or rejected binary falls back to compiling from source
+    int linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (linked == GL_FALSE)
+    {
+        glDeleteProgram(program);
+        return 0;
+    }
     return program;
+}
+
+void Shader::SaveProgramBinary() const
+{
+    int length = 0;
+    GLCall(glGetProgramiv(m_RendererID, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format = 0;
+    GLCall(glGetProgramBinary(m_RendererID, length, &length, &format, binary.data()));
+
+    MAKE_DIRECTORY(SHADER_CACHE_DIRECTORY);
+    std::ofstream file(m_CachePath, std::ios::binary);
+    if (!file.is_open())
+        return;
+    file.write((const char*)&format, sizeof(format));
+    file.write(binary.data(), length);
+}
+
+void Shader::Finalize() const
+{
+    if (!m_Pending)
+        return;
+    m_Pending = false;
+
+    int linked = GL_FALSE;
+    GLCall(glGetProgramiv(m_RendererID, GL_LINK_STATUS, &linked));
+    if (linked == GL_FALSE)
+    {
+        for (unsigned int id : m_PendingShaders)
+        {
+            int result, type;
+            glGetShaderiv(id, GL_COMPILE_STATUS, &result);
+            if (result == GL_TRUE)
+                continue;
+            glGetShaderiv(id, GL_SHADER_TYPE, &type);
+            int length;
+            glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+            std::string message(length > 0 ? length : 1, '\0');
+            glGetShaderInfoLog(id, length, &length, &message[0]);
+            std::cout << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" :
+                (type == GL_FRAGMENT_SHADER ? "fragment" : "geometry")) << " shader!" << std::endl;
+            std::cout << message << std::endl;
+        }
+        int length;
+        glGetProgramiv(m_RendererID, GL_INFO_LOG_LENGTH, &length);
+        std::string message(length > 0 ? length : 1, '\0');
+        glGetProgramInfoLog(m_RendererID, length, &length, &message[0]);
+        std::cout << "Failed to link " << m_FilePath << "!" << std::endl;
+        std::cout << message << std::endl;
+    }
+    else if (m_SaveBinary)
+    {
+        SaveProgramBinary();
+    }
+
+    for (unsigned int id : m_PendingShaders)
+        glDeleteShader(id);
+    m_PendingShaders.clear();
 
+    if (linked == GL_TRUE)
+        ReflectUniforms();
 }
 
 
 void Shader::Bind() const
 {
-    GLCall(glUseProgram(m_RendererID));
+    Finalize();
+    GLState::UseProgram(m_RendererID);
 }
 
 void Shader::Unbind() const
 {
-    GLCall(glUseProgram(0));
+    GLState::UseProgram(0);
+}
+
+#ifndef NDEBUG
+// Setters must match the type glGetActiveUniform reported; handles of missing uniforms are GL no-ops.
+// A bool may also be set with glUniform1f.
+static bool UniformTypeIs(UniformHandle uniform, unsigned int type)
+{
+    return !uniform.IsValid() || uniform.type == type || (type == GL_FLOAT && uniform.type == GL_BOOL);
+}
+
+// glUniform1i sets ints, bools and sampler units
+static bool UniformTypeIsInt(UniformHandle uniform)
+{
+    if (!uniform.IsValid())
+        return true;
+    switch (uniform.type)
+    {
+    case GL_INT: case GL_BOOL:
+    case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_ARRAY_SHADOW:
+        return true;
+    default:
+        return false;
+    }
+}
+#endif
+
+void Shader::SetUniform1i(UniformHandle uniform, int value)
+{
+    assert(UniformTypeIsInt(uniform) && "SetUniform1i on a uniform of another type");
+    GLCall(glUniform1i(uniform.location, value));
+    RenderStats::Get().uniformUploads++;
+}
+
+void Shader::SetUniform1f(UniformHandle uniform, float value)
+{
+    assert(UniformTypeIs(uniform, GL_FLOAT) && "SetUniform1f on a uniform of another type");
+    GLCall(glUniform1f(uniform.location, value));
+    RenderStats::Get().uniformUploads++;
+}
+
+void Shader::SetUniform3f(UniformHandle uniform, glm::vec3 value)
+{
+    assert(UniformTypeIs(uniform, GL_FLOAT_VEC3) && "SetUniform3f on a uniform of another type");
+    GLCall(glUniform3f(uniform.location, value.x, value.y, value.z));
+    RenderStats::Get().uniformUploads++;
+}
+
+void Shader::SetUniform4f(UniformHandle uniform, glm::vec4 value)
+{
+    assert(UniformTypeIs(uniform, GL_FLOAT_VEC4) && "SetUniform4f on a uniform of another type");
+    GLCall(glUniform4f(uniform.location, value.x, value.y, value.z, value.w));
+    RenderStats::Get().uniformUploads++;
+}
+
+void Shader::SetUniformMat4f(UniformHandle uniform, const glm::mat4& mat)
+{
+    assert(UniformTypeIs(uniform, GL_FLOAT_MAT4) && "SetUniformMat4f on a uniform of another type");
+    GLCall(glUniformMatrix4fv(uniform.location, 1, GL_FALSE, &mat[0][0]));
+    RenderStats::Get().uniformUploads++;
 }
 
 void Shader::SetUniform1i(const std::string& name, int value)
 {
-    GLCall(glUniform1i(GetUniformLocation(name), value));
+    SetUniform1i(GetUniform(name), value);
 }
 
 void Shader::SetUniform1f(const std::string& name, float value)
 {
-    GLCall(glUniform1f(GetUniformLocation(name), value));
+    SetUniform1f(GetUniform(name), value);
 }
 
 void Shader::SetUniform3f(const std::string& name, glm::vec3 value)
 {
-    GLCall(glUniform3f(GetUniformLocation(name), value.x, value.y, value.z));
+    SetUniform3f(GetUniform(name), value);
 }
 
 void Shader::SetUniform4f(const std::string& name, glm::vec4 value)
 {
-    GLCall(glUniform4f(GetUniformLocation(name), value.x, value.y, value.z, value.w));
+    SetUniform4f(GetUniform(name), value);
 }
 
 void Shader::SetUniformMat4f(const std::string& name, const glm::mat4& mat)
 {
-    GLCall(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &mat[0][0]));
+    SetUniformMat4f(GetUniform(name), mat);
 }
 
-int Shader::GetUniformLocation(const std::string& name)
+void Shader::BindUniformBlock(const std::string& name, unsigned int binding)
 {
-    if (m_UniformLocationCache.find(name) != m_UniformLocationCache.end())
-        return m_UniformLocationCache[name];
-
-    GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
-    if (location == -1)
-        std::cout << "Warning: Uniform ' " << name << " ' doesnot exist!" << std::endl;
+    Finalize();
+    GLCall(unsigned int index = glGetUniformBlockIndex(m_RendererID, name.c_str()));
+    if (index == GL_INVALID_INDEX)
+        return;
+    GLCall(glUniformBlockBinding(m_RendererID, index, binding));
+}
 
-    m_UniformLocationCache[name] = location;
+void Shader::ReflectUniforms() const
+{
+    int count = 0, maxLength = 0;
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count));
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+    std::string name(maxLength > 0 ? maxLength : 1, '\0');
+    for (int i = 0; i < count; i++)
+    {
+        int length = 0, size = 0;
+        unsigned int type = 0;
+        GLCall(glGetActiveUniform(m_RendererID, i, maxLength, &length, &size, &type, &name[0]));
+        std::string uniformName = name.substr(0, length);
+
+        UniformHandle uniform;
+        GLCall(uniform.location = glGetUniformLocation(m_RendererID, uniformName.c_str()));
+        uniform.type = type;
+        if (uniform.location == -1) // Uniform block member
+            continue;
+
+        m_Uniforms[uniformName] = uniform;
+        // Arrays are reported as "name[0]"; allow addressing them by their plain name too
+        size_t bracket = uniformName.find('[');
+        if (bracket != std::string::npos)
+            m_Uniforms[uniformName.substr(0, bracket)] = uniform;
+    }
+}
 
-	return location;
+bool Shader::HasUniform(const std::string& name)
+{
+    Finalize();
+    auto it = m_Uniforms.find(name);
+    return it != m_Uniforms.end() && it->second.IsValid();
 }
 
+UniformHandle Shader::GetUniform(const std::string& name)
+{
+    Finalize();
+    auto it = m_Uniforms.find(name);
+    if (it != m_Uniforms.end())
+        return it->second;
+
+    // Not active in the program; remember the miss so it's reported only once
+    std::cout << "Warning: Uniform ' " << name << " ' doesnot exist!" << std::endl;
+    m_Uniforms[name] = UniformHandle();
+    return UniformHandle();
+}
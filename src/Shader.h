@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <glm/glm.hpp>
 
 struct ShaderProgramSource
@@ -10,32 +11,68 @@ struct ShaderProgramSource
 	std::string fragmentSource;
 };
 
+// Uniform resolved once by name; setting through it is a plain location lookup
+struct UniformHandle
+{
+	int location = -1;
+	unsigned int type = 0; // GL_FLOAT, GL_SAMPLER_2D, ... as reported by glGetActiveUniform; setters assert it in debug builds
+
+	bool IsValid() const { return location != -1; }
+};
+
 class Shader
 {
 public:
-	Shader(const std::string& filepath);
+	// Each define is injected as "#define NAME" right after the #version line of every stage, after the
+	// engine constants (SHADOW_CASCADES, BLOOM_MIPS, ...). A stage line #include "file" pastes file, relative to filepath.
+	Shader(const std::string& filepath, const std::vector<std::string>& defines = std::vector<std::string>());
 	~Shader();
 
 	void Bind() const;
 	void Unbind() const;
 	unsigned int GetID() { return m_RendererID; }
 
+	// Resolve a uniform once; misses are reported a single time
+	UniformHandle GetUniform(const std::string& name);
+	// Quiet check, for uniforms that some variants compile out
+	bool HasUniform(const std::string& name);
+
 	// Set Uniforms
+	void SetUniform1i(UniformHandle uniform, int value);
+	void SetUniform1f(UniformHandle uniform, float value);
+	void SetUniform3f(UniformHandle uniform, glm::vec3 value);
+	void SetUniform4f(UniformHandle uniform, glm::vec4 value);
+	void SetUniformMat4f(UniformHandle uniform, const glm::mat4& mat);
 	void SetUniform1i(const std::string& name, int value);
 	void SetUniform1f(const std::string& name, float value);
 	void SetUniform3f(const std::string& name, glm::vec3 value);
 	void SetUniform4f(const std::string& name, glm::vec4 value);
 	void SetUniformMat4f(const std::string& name, const glm::mat4& mat);
 
+	// Attach a uniform block to a UniformBuffer binding point (no-op if the program lacks it)
+	void BindUniformBlock(const std::string& name, unsigned int binding);
+
 private:
 	ShaderProgramSource ParseShader(const std::string& filepath);
 	unsigned int CompileShader(unsigned int type, const std::string& source);
 	unsigned int CreateShader(const std::string& vertexShader, const std::string& geometryShader, const std::string& fragmentShader);
-	int GetUniformLocation(const std::string& name);
+	void ReflectUniforms() const;
+
+	// Program binary cache, keyed by the sources and the driver
+	unsigned int LoadProgramBinary() const;
+	void SaveProgramBinary() const;
 
+	// Compile and link are only checked on first use, so programs created back to back
+	// are all submitted before the first one is waited on
+	void Finalize() const;
 
 private:
-	unsigned int m_RendererID;
 	std::string m_FilePath;
-	std::unordered_map<std::string, int> m_UniformLocationCache;
+	std::vector<std::string> m_Defines;
+	unsigned int m_RendererID;
+	std::string m_CachePath;
+	mutable std::vector<unsigned int> m_PendingShaders;
+	mutable bool m_Pending = true;
+	mutable bool m_SaveBinary = false;
+	mutable std::unordered_map<std::string, UniformHandle> m_Uniforms;
 };
@@ -0,0 +1,41 @@
+#include "ShaderVariants.h"
+
+ShaderVariants::ShaderVariants(const std::string& filepath, const std::vector<std::string>& features,
+    std::function<void(Shader&)> setup)
+    : m_FilePath(filepath), m_Features(features), m_Setup(setup)
+{
+}
+
+std::shared_ptr<Shader> ShaderVariants::Get(unsigned int mask)
+{
+    auto it = m_Variants.find(mask);
+    if (it != m_Variants.end())
+        return it->second;
+
+    std::vector<std::string> defines;
+    for (unsigned int i = 0; i < m_Features.size(); i++)
+    {
+        if (mask & (1u << i))
+            defines.push_back(m_Features[i]);
+    }
+    std::shared_ptr<Shader> shader = std::make_shared<Shader>(m_FilePath, defines);
+    if (m_Setup)
+    {
+        shader->Bind();
+        m_Setup(*shader);
+    }
+    m_Variants[mask] = shader;
+    return shader;
+}
+
+std::shared_ptr<Shader> ShaderVariants::Get(std::initializer_list<bool> enabled)
+{
+    unsigned int mask = 0, bit = 0;
+    for (bool flag : enabled)
+    {
+        if (flag)
+            mask |= 1u << bit;
+        bit++;
+    }
+    return Get(mask);
+}
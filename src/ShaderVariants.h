@@ -0,0 +1,32 @@
+#pragma once
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Shader.h"
+
+// Specialized programs of one .shader file, one per combination of feature defines.
+// Variants are compiled on first request and cached, so toggling a setting back is free.
+class ShaderVariants
+{
+public:
+	// setup runs once on every freshly compiled variant (samplers, uniform blocks, ...)
+	ShaderVariants(const std::string& filepath, const std::vector<std::string>& features,
+		std::function<void(Shader&)> setup = nullptr);
+
+	// Bit i of mask enables features[i]
+	std::shared_ptr<Shader> Get(unsigned int mask);
+	// One flag per feature, in the order given to the constructor
+	std::shared_ptr<Shader> Get(std::initializer_list<bool> enabled);
+
+	unsigned int GetCompiledCount() const { return (unsigned int)m_Variants.size(); }
+
+private:
+	std::string m_FilePath;
+	std::vector<std::string> m_Features;
+	std::function<void(Shader&)> m_Setup;
+	std::unordered_map<unsigned int, std::shared_ptr<Shader>> m_Variants;
+};
@@ -0,0 +1,124 @@
+#include "ShadowCascades.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+static const ShadowRegion FullRegion{ glm::vec2(-1.0f), glm::vec2(1.0f) };
+
+ShadowCascades::ShadowCascades(const float (&radii)[SHADOW_CASCADES], float depthPadding)
+    : m_DepthPadding(depthPadding)
+{
+    for (int i = 0; i < SHADOW_CASCADES; i++)
+    {
+        m_Radius[i] = radii[i];
+        m_Origin[i] = glm::vec3(0.0f);
+        m_LightPV[i] = glm::mat4(1.0f);
+    }
+    Invalidate();
+}
+
+void ShadowCascades::Update(const glm::vec3& cameraPos, const glm::vec3& lightDir)
+{
+    glm::vec3 dir = glm::normalize(lightDir);
+    if (dir != m_LightDir)
+        Invalidate();
+    m_LightDir = dir;
+
+    // Rotation into light space; all cascades share it and differ by a translation only
+    glm::vec3 up = std::abs(dir.y) > 0.99f ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(0.0f, 1.0f, 0.0f);
+    glm::mat4 lightRotation = glm::lookAt(glm::vec3(0.0f), dir, up);
+    glm::vec3 cameraLightSpace = glm::vec3(lightRotation * glm::vec4(cameraPos, 1.0f));
+
+    for (int i = 0; i < SHADOW_CASCADES; i++)
+    {
+        float radius = m_Radius[i];
+        float texel = 2.0f * radius / SHADOW_CASCADE_SIZE;
+        float step = texel * SHADOW_SNAP_TEXELS;
+        glm::vec3 origin = glm::floor(cameraLightSpace / step) * step;
+        if (origin != m_Origin[i])
+        {
+            m_Origin[i] = origin;
+            m_Pending[i] = FullRegion;
+        }
+        // The camera may sit up to one step off centre; the shader picks cascades by fit
+        float depth = radius + m_DepthPadding;
+        m_LightPV[i] = glm::ortho(-radius, radius, -radius, radius, -depth, depth)
+            * glm::translate(glm::mat4(1.0f), -origin) * lightRotation;
+    }
+}
+
+void ShadowCascades::MarkDirty(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+{
+    for (int i = 0; i < SHADOW_CASCADES; i++)
+    {
+        glm::vec3 ndcMin, ndcMax;
+        Project(i, boundsMin, boundsMax, ndcMin, ndcMax);
+        if (ndcMin.x > 1.0f || ndcMax.x < -1.0f || ndcMin.y > 1.0f || ndcMax.y < -1.0f)
+            continue;
+        m_Pending[i].min = glm::max(glm::min(m_Pending[i].min, glm::vec2(ndcMin.x, ndcMin.y)), glm::vec2(-1.0f));
+        m_Pending[i].max = glm::min(glm::max(m_Pending[i].max, glm::vec2(ndcMax.x, ndcMax.y)), glm::vec2(1.0f));
+    }
+}
+
+void ShadowCascades::Invalidate()
+{
+    for (int i = 0; i < SHADOW_CASCADES; i++)
+        m_Pending[i] = FullRegion;
+}
+
+unsigned int ShadowCascades::TakeDirty()
+{
+    unsigned int mask = 0;
+    for (int i = 0; i < SHADOW_CASCADES; i++)
+    {
+        m_Region[i] = m_Pending[i];
+        m_Pending[i] = ShadowRegion();
+        if (!m_Region[i].IsEmpty())
+            mask |= 1u << i;
+    }
+    return mask;
+}
+
+void ShadowCascades::GetScissor(int cascade, int& x, int& y, int& width, int& height) const
+{
+    // One texel of padding against rounding at the region border
+    const ShadowRegion& region = m_Region[cascade];
+    int x0 = (int)std::floor((region.min.x * 0.5f + 0.5f) * SHADOW_CASCADE_SIZE) - 1;
+    int y0 = (int)std::floor((region.min.y * 0.5f + 0.5f) * SHADOW_CASCADE_SIZE) - 1;
+    int x1 = (int)std::ceil((region.max.x * 0.5f + 0.5f) * SHADOW_CASCADE_SIZE) + 1;
+    int y1 = (int)std::ceil((region.max.y * 0.5f + 0.5f) * SHADOW_CASCADE_SIZE) + 1;
+    x = std::max(x0, 0);
+    y = std::max(y0, 0);
+    width = std::min(x1, SHADOW_CASCADE_SIZE) - x;
+    height = std::min(y1, SHADOW_CASCADE_SIZE) - y;
+}
+
+bool ShadowCascades::Overlaps(int cascade, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const
+{
+    const ShadowRegion& region = m_Region[cascade];
+    glm::vec3 ndcMin, ndcMax;
+    Project(cascade, boundsMin, boundsMax, ndcMin, ndcMax);
+    return ndcMin.x <= region.max.x && ndcMax.x >= region.min.x
+        && ndcMin.y <= region.max.y && ndcMax.y >= region.min.y
+        && ndcMin.z <= 1.0f && ndcMax.z >= -1.0f;
+}
+
+void ShadowCascades::Project(int cascade, const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+    glm::vec3& ndcMin, glm::vec3& ndcMax) const
+{
+    // Orthographic, so the projected corners bound the box in NDC directly
+    ndcMin = glm::vec3(std::numeric_limits<float>::max());
+    ndcMax = glm::vec3(-std::numeric_limits<float>::max());
+    for (int corner = 0; corner < 8; corner++)
+    {
+        glm::vec3 point((corner & 1) ? boundsMax.x : boundsMin.x,
+            (corner & 2) ? boundsMax.y : boundsMin.y,
+            (corner & 4) ? boundsMax.z : boundsMin.z);
+        glm::vec3 ndc = glm::vec3(m_LightPV[cascade] * glm::vec4(point, 1.0f));
+        ndcMin = glm::min(ndcMin, ndc);
+        ndcMax = glm::max(ndcMax, ndc);
+    }
+}
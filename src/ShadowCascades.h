@@ -0,0 +1,57 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include "Renderer.h"
+
+// Origins move in steps of this many texels, so a slowly moving camera rarely forces a redraw
+#define SHADOW_SNAP_TEXELS 64
+
+// Part of a cascade that has to be redrawn, in the NDC of its light box
+struct ShadowRegion
+{
+	glm::vec2 min{ 1.0f };
+	glm::vec2 max{ -1.0f };
+
+	bool IsEmpty() const { return min.x > max.x || min.y > max.y; }
+};
+
+// Light-space boxes of the cascaded shadow map, nearest first.
+// Origins are snapped to the texel grid of each cascade, and only what changed is redrawn:
+// a whole cascade when the light turns or its origin moves, and the projected bounds of
+// changed chunks otherwise. A static light and camera cost no shadow work at all.
+class ShadowCascades
+{
+public:
+	// radii: half extent of each cascade box in world units, ascending
+	ShadowCascades(const float (&radii)[SHADOW_CASCADES], float depthPadding);
+
+	// Recompute the light boxes; cascades whose box moved are marked dirty as a whole
+	void Update(const glm::vec3& cameraPos, const glm::vec3& lightDir);
+	// A world-space AABB changed (chunk loaded, dropped or remeshed)
+	void MarkDirty(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+	// Everything has to be redrawn
+	void Invalidate();
+
+	// Bitmask of the cascades to redraw this frame; their regions stay valid until the next call
+	unsigned int TakeDirty();
+	const ShadowRegion& GetRegion(int cascade) const { return m_Region[cascade]; }
+	// Region of this frame in tile pixels, for the scissor
+	void GetScissor(int cascade, int& x, int& y, int& width, int& height) const;
+
+	const glm::mat4& GetLightPV(int cascade) const { return m_LightPV[cascade]; }
+	// Whether a world-space AABB reaches into the region of a cascade redrawn this frame
+	bool Overlaps(int cascade, const glm::vec3& boundsMin, const glm::vec3& boundsMax) const;
+
+private:
+	void Project(int cascade, const glm::vec3& boundsMin, const glm::vec3& boundsMax,
+		glm::vec3& ndcMin, glm::vec3& ndcMax) const;
+
+private:
+	float m_Radius[SHADOW_CASCADES];
+	float m_DepthPadding;
+	glm::vec3 m_Origin[SHADOW_CASCADES];
+	glm::mat4 m_LightPV[SHADOW_CASCADES];
+	glm::vec3 m_LightDir{ 0.0f };
+	ShadowRegion m_Pending[SHADOW_CASCADES];
+	ShadowRegion m_Region[SHADOW_CASCADES];
+};
@@ -5,6 +5,8 @@
 
 #include <iostream>
 
+#include "GLState.h"
+
 Texture::Texture(const std::string& path)
 	:m_RendererID(0), m_FilePath(0), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
 {
@@ -15,6 +17,7 @@ Texture::Texture(const std::string& path)
 
 Texture::~Texture()
 {
+	GLState::ForgetTexture(m_RendererID);
 	GLCall(glDeleteTextures(1, &m_RendererID));
 }
 
@@ -39,12 +42,11 @@ void Texture::AddTexture(const std::string& path, unsigned int slot)
 
 void Texture::BuildTexture(unsigned int slot)
 {
-	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
 	stbi_set_flip_vertically_on_load(1);
 	m_LocalBuffer = stbi_load(m_FilePath[slot].c_str(), &m_Width, &m_Height, &m_BPP, 4);
 
 	GLCall(glGenTextures(1, &m_RendererID));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLState::BindTexture(slot, m_RendererID);
 
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST));
 	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST));
@@ -53,7 +55,7 @@ void Texture::BuildTexture(unsigned int slot)
 
 	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
 	GLCall(glGenerateMipmap(GL_TEXTURE_2D));
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLState::BindTexture(slot, 0);
 
 	if (m_LocalBuffer)
 		stbi_image_free(m_LocalBuffer);
@@ -61,11 +63,10 @@ void Texture::BuildTexture(unsigned int slot)
 
 void Texture::Bind(unsigned int slot) const
 {
-	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLState::BindTexture(slot, m_RendererID);
 }
 
-void Texture::Unbind() const
+void Texture::Unbind(unsigned int slot) const
 {
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLState::BindTexture(slot, 0);
 }
@@ -0,0 +1,108 @@
+#include "Trace.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <unordered_map>
+
+// One event. The fields are atomics only so a concurrent dump is well defined;
+// sequence is 2 * index + 2 once event number index is complete, odd while it is written.
+struct TraceEvent
+{
+    std::atomic<uint64_t> sequence{ 0 };
+    std::atomic<const char*> name{ nullptr };
+    std::atomic<uint64_t> time{ 0 };     // ns since the first event
+    std::atomic<uint32_t> thread{ 0 };
+    std::atomic<char> phase{ 'B' };
+};
+
+static TraceEvent s_Events[TRACE_CAPACITY];
+static std::atomic<uint64_t> s_Next{ 0 };
+static std::atomic<uint32_t> s_ThreadCount{ 0 };
+static const std::chrono::steady_clock::time_point s_Start = std::chrono::steady_clock::now();
+
+std::atomic<bool> Trace::s_Enabled{ true };
+
+// Small, stable id per thread; the main thread is usually 1
+static uint32_t CurrentThread()
+{
+    thread_local uint32_t id = ++s_ThreadCount;
+    return id;
+}
+
+void Trace::Begin(const char* name)
+{
+    if (IsEnabled())
+        Record(name, 'B');
+}
+
+void Trace::End(const char* name)
+{
+    if (IsEnabled())
+        Record(name, 'E');
+}
+
+void Trace::Record(const char* name, char phase)
+{
+    uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - s_Start).count();
+    uint64_t index = s_Next.fetch_add(1, std::memory_order_relaxed);
+    TraceEvent& event = s_Events[index & (TRACE_CAPACITY - 1)];
+
+    event.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name.store(name, std::memory_order_relaxed);
+    event.time.store(time, std::memory_order_relaxed);
+    event.thread.store(CurrentThread(), std::memory_order_relaxed);
+    event.phase.store(phase, std::memory_order_relaxed);
+    event.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+bool Trace::Dump(const std::string& filepath)
+{
+    FILE* file = std::fopen(filepath.c_str(), "w");
+    if (!file)
+    {
+        std::cout << "Failed to write trace " << filepath << std::endl;
+        return false;
+    }
+
+    uint64_t end = s_Next.load(std::memory_order_acquire);
+    uint64_t begin = end > TRACE_CAPACITY ? end - TRACE_CAPACITY : 0;
+    // Open spans per thread: an end whose begin was already overwritten is dropped
+    std::unordered_map<uint32_t, int> depth;
+    unsigned int written = 0;
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (uint64_t index = begin; index < end; index++)
+    {
+        TraceEvent& event = s_Events[index & (TRACE_CAPACITY - 1)];
+        if (event.sequence.load(std::memory_order_acquire) != 2 * index + 2)
+            continue; // still being written, or already overwritten
+        const char* name = event.name.load(std::memory_order_relaxed);
+        uint64_t time = event.time.load(std::memory_order_relaxed);
+        uint32_t thread = event.thread.load(std::memory_order_relaxed);
+        char phase = event.phase.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (event.sequence.load(std::memory_order_relaxed) != 2 * index + 2)
+            continue; // overwritten while it was copied
+
+        int& open = depth[thread];
+        if (phase == 'E')
+        {
+            if (open == 0)
+                continue;
+            open--;
+        }
+        else
+            open++;
+
+        std::fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+            written ? ",\n" : "", name, phase, time / 1000.0, thread);
+        written++;
+    }
+    std::fprintf(file, "\n]}\n");
+    std::fclose(file);
+
+    std::cout << "Wrote " << written << " trace events to " << filepath << std::endl;
+    return true;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Events kept; older ones are overwritten. Must be a power of two.
+#define TRACE_CAPACITY (1 << 16)
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+// Trace the enclosing block; name must outlive the trace (a string literal)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+
+// Begin/end events of named spans on every thread, kept in a fixed ring buffer and
+// written out as Chrome trace JSON (chrome://tracing, ui.perfetto.dev) on demand.
+// Recording is lock-free: a writer claims a slot with one atomic increment, and the
+// slot's sequence number tells the dump whether it holds a complete event.
+class Trace
+{
+public:
+	static void Begin(const char* name);
+	static void End(const char* name);
+
+	// Recording is on unless switched off
+	static void SetEnabled(bool enabled) { s_Enabled.store(enabled, std::memory_order_relaxed); }
+	static bool IsEnabled() { return s_Enabled.load(std::memory_order_relaxed); }
+
+	// Write the events still in the ring; may run while other threads keep recording
+	static bool Dump(const std::string& filepath);
+
+private:
+	static void Record(const char* name, char phase);
+
+	static std::atomic<bool> s_Enabled;
+};
+
+class TraceScope
+{
+public:
+	TraceScope(const char* name) : m_Name(name) { Trace::Begin(m_Name); }
+	~TraceScope() { Trace::End(m_Name); }
+
+private:
+	const char* m_Name;
+};
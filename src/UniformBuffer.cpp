@@ -0,0 +1,30 @@
+#include "UniformBuffer.h"
+
+#include "Renderer.h"
+#include "RenderStats.h"
+
+UniformBuffer::UniformBuffer(unsigned int size, unsigned int binding)
+    : m_Binding(binding)
+{
+    GLCall(glGenBuffers(1, &m_RendererID));
+    GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+    GLCall(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+    Bind();
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+void UniformBuffer::SetData(const void* data, unsigned int size, unsigned int offset) const
+{
+    GLCall(glBindBuffer(GL_UNIFORM_BUFFER, m_RendererID));
+    GLCall(glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data));
+    RenderStats::CountBufferBytes(size);
+}
+
+void UniformBuffer::Bind() const
+{
+    GLCall(glBindBufferBase(GL_UNIFORM_BUFFER, m_Binding, m_RendererID));
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include "Renderer.h"
+
+// Binding points shared by every program
+#define PER_FRAME_BINDING 0
+#define MATERIAL_BINDING 1
+
+// std140 mirror of the PerFrame block (res/shaders/PerFrame.glsl)
+struct PerFrameUniforms
+{
+	glm::mat4 model;
+	glm::mat4 view;
+	glm::mat4 proj;
+	glm::mat4 lightPV[SHADOW_CASCADES];
+	glm::vec3 cameraPos;
+	float time;
+	glm::vec3 lightPos;
+	int waterGeometry;
+};
+static_assert(sizeof(PerFrameUniforms) == 480, "PerFrameUniforms must match the std140 PerFrame block");
+
+// std140 mirror of the Material block in the shaders
+struct MaterialUniforms
+{
+	float lightIntensity;
+	float kd;
+	float ks;
+	float padding;
+};
+static_assert(sizeof(MaterialUniforms) == 16, "MaterialUniforms must match the std140 Material block");
+
+class UniformBuffer
+{
+public:
+	UniformBuffer(unsigned int size, unsigned int binding);
+	~UniformBuffer();
+
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0) const;
+	void Bind() const;
+
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Binding;
+};
@@ -1,6 +1,7 @@
 #include "VertexArray.h"
 #include "Renderer.h"
 #include "VertexBufferLayout.h"
+#include "GLState.h"
 
 VertexArray::VertexArray()
 {
@@ -9,20 +10,31 @@ VertexArray::VertexArray()
 
 VertexArray::~VertexArray()
 {
+	GLState::ForgetVertexArray(m_RendererID);
 	GLCall(glDeleteVertexArrays(1, &m_RendererID));
 }
 
 void VertexArray::Bind() const
 {
-	GLCall(glBindVertexArray(m_RendererID));
+	GLState::BindVertexArray(m_RendererID);
 }
 
 void VertexArray::Unbind() const
 {
-	GLCall(glBindVertexArray(0));
+	GLState::BindVertexArray(0);
 }
 
 void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
+{
+	AddAttributes(vb, layout, 0);
+}
+
+void VertexArray::AddInstanceBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout)
+{
+	AddAttributes(vb, layout, 1);
+}
+
+void VertexArray::AddAttributes(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int divisor)
 {
 	vb.Bind();
 	const auto& elements = layout.GetElements();
@@ -30,10 +42,16 @@ void VertexArray::AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& la
 	for (unsigned int i = 0; i < elements.size(); i++)
 	{
 		const auto element = elements[i];
-		GLCall(glVertexAttribPointer(i, element.count, element.type, 
+		unsigned int index = m_AttribCount + i;
+		GLCall(glVertexAttribPointer(index, element.count, element.type, 
 			element.normalized, layout.GetStride(), (const void*)offset));
-		GLCall(glEnableVertexAttribArray(i));
+		GLCall(glEnableVertexAttribArray(index));
+		if (divisor != 0)
+		{
+			GLCall(glVertexAttribDivisor(index, divisor));
+		}
 
 		offset += element.count * VertexBufferElement::GetSizeOfType(element.type);
 	}
+	m_AttribCount += elements.size();
 }
@@ -14,7 +14,13 @@ public:
 	void Unbind() const;
 
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	// Attributes continue after the ones already added and advance once per instance
+	void AddInstanceBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+
+private:
+	void AddAttributes(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int divisor);
 
 private:
 	unsigned int m_RendererID;
+	unsigned int m_AttribCount = 0;
 };
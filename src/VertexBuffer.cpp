@@ -1,12 +1,14 @@
 #include "VertexBuffer.h"
 
 #include "Renderer.h"
+#include "RenderStats.h"
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
 {
     GLCall(glGenBuffers(1, &m_RendererID));
     GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
     GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
+    RenderStats::CountBufferBytes(size);
 }
 
 VertexBuffer::~VertexBuffer()
@@ -1,4 +1,6 @@
 #include "World.h"
+#include "Trace.h"
+#include "AllocTracker.h"
 
 World::World(int chunkSize, int distance, unsigned int seed)
 {
@@ -32,17 +34,21 @@ void World::SetRenderDistance(int distance)
 	m_RenderDistance = distance;
 }
 
-void World::Generate(unsigned int seed)
+void World::Generate(unsigned int seed, std::vector<std::shared_ptr<Shader>> shader)
 {
+	m_Seed = seed;
 	for (auto entry : m_ChunkData)
 	{
 		auto chunkPtr = entry.second;
-		chunkPtr->Generate(seed);
+		chunkPtr->Generate(seed, shader);
+		MarkChanged(entry.first);
 	}
 }
 
 void World::Update(std::vector<std::shared_ptr<Shader>> shader, glm::vec3 cameraPos)
 {
+	TRACE_SCOPE("World::Update");
+	AllocScope allocScope(AllocTag::World);
 	if (!m_ChunkQueue.empty())
 	{
 		std::pair<int, int> key = m_ChunkQueue.front();
@@ -52,9 +58,9 @@ void World::Update(std::vector<std::shared_ptr<Shader>> shader, glm::vec3 camera
 		{
 			auto chunkPtr = std::make_shared<Chunk>(m_ChunkSize,
 				glm::vec3(key.first * m_ChunkSize, 0.0f, key.second * m_ChunkSize));
-			chunkPtr->Generate(m_Seed);
-			chunkPtr->RenderInitialize(shader);
+			chunkPtr->Generate(m_Seed, shader);
 			m_ChunkData[key] = chunkPtr;
+			MarkChanged(key);
 		}
 	}
 	
@@ -85,6 +91,8 @@ void World::Update(std::vector<std::shared_ptr<Shader>> shader, glm::vec3 camera
 				abs(key.second - (int)currentChunkPos.z) >= m_RenderDistance)
 			{
 				//entry.second->~Chunk();  // Deleted automatically
+				MarkChanged(key);
+				TRACE_SCOPE("Chunk Destroy");
 				it = m_ChunkData.erase(it);
 				//std::cout << "x " << (abs(key.first - (int)currentChunkPos.x) >= m_RenderDistance) << std::endl;
 				//std::cout << "z " << (abs(key.second - (int)currentChunkPos.z) >= m_RenderDistance) << std::endl;
@@ -99,6 +107,19 @@ void World::Update(std::vector<std::shared_ptr<Shader>> shader, glm::vec3 camera
 	lastChunkPos = currentChunkPos;
 }
 
+std::vector<std::pair<glm::vec3, glm::vec3>> World::TakeChangedBounds()
+{
+	std::vector<std::pair<glm::vec3, glm::vec3>> changed;
+	changed.swap(m_ChangedBounds);
+	return changed;
+}
+
+void World::MarkChanged(std::pair<int, int> key)
+{
+	glm::vec3 origin(key.first * m_ChunkSize, 0.0f, key.second * m_ChunkSize);
+	m_ChangedBounds.emplace_back(origin, origin + glm::vec3((float)m_ChunkSize));
+}
+
 glm::ivec3 World::GetCurrentChunkPos()
 {
 	return lastChunkPos;
@@ -24,19 +24,28 @@ public:
 
 	void SetRenderDistance(int distance);
 	int GetRenderDistance() { return m_RenderDistance; };
-	void Generate(unsigned int seed);
+	// Regenerate every loaded chunk with a new seed
+	void Generate(unsigned int seed, std::vector<std::shared_ptr<Shader>> shader);
 	void Update(std::vector<std::shared_ptr<Shader>> shader, glm::vec3 cameraPos);
 	glm::ivec3 GetCurrentChunkPos();
 	BlockType GetBlockType(glm::vec3 pos);
 
 	size_t GetChunkNum();
+	// Chunks waiting to be generated, one is taken per Update()
+	size_t GetQueueLength() const { return m_ChunkQueue.size(); }
+	// Bounds of the chunks added, removed or regenerated since the last call
+	std::vector<std::pair<glm::vec3, glm::vec3>> TakeChangedBounds();
 	std::unordered_map<std::pair<int, int>, std::shared_ptr<Chunk>, pair_hash> GetChunkData();
 
+private:
+	void MarkChanged(std::pair<int, int> key);
+
 private:
 	int m_RenderDistance = 1, m_lastRenderDistance = 0;
 	int m_ChunkSize;
 	unsigned int m_Seed = 0;
 	glm::ivec3 lastChunkPos;
+	std::vector<std::pair<glm::vec3, glm::vec3>> m_ChangedBounds;
 
 	std::unordered_map<std::pair<int, int>, std::shared_ptr<Chunk>, pair_hash> m_ChunkData;
 	std::queue<std::pair<int, int>> m_ChunkQueue;
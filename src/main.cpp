@@ -5,6 +5,9 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <string>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
 #include <iostream>
 
 #include "imgui.h"
@@ -17,13 +20,25 @@
 #include "Texture.h"
 #include "Camera.h"
 #include "World.h"
+#include "GLState.h"
+#include "UniformBuffer.h"
+#include "ShaderVariants.h"
+#include "ShadowCascades.h"
+#include "RenderScale.h"
+#include "CameraPath.h"
+#include "FrameTimings.h"
+#include "FrameCapture.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "RenderStats.h"
+#include "AllocTracker.h"
 
 float deltaTime = 0.0f;
 float lastFrameTime = 0.0f;
 
 int width = 1280;
 int height = 720;
-std::shared_ptr<FrameBuffer> fboPtr;
+FrameBuffer* fboPtr = nullptr;
 
 struct Settings
 {
@@ -31,7 +46,12 @@ struct Settings
     bool Shadow = true;
     bool PCF = true;
     bool PCSS = false;
+    bool VSM = false;
     bool VSync = false;
+    bool dynamicResolution = true;
+    float targetFrameTime = 1000.0f / 60.0f; // ms
+    bool compactTargets = true;
+    bool depthPrepass = true;
     float brightness = 0.0f;
     float contrast = 1.0f;
     float saturation = 1.2f;
@@ -49,19 +69,105 @@ struct Settings
     bool waterGeometry = false;
 };
 
+// Command line:
+//   --record path      save the camera pose of every frame to path on exit
+//   --replay path      fly the recorded path with a fixed timestep, then quit
+//   --timings path     per-frame CPU/GPU times as CSV (with --replay or --headless)
+//   --timestep sec     replay step, default 1/60
+//   --headless         hidden window, no ImGui, fixed timestep; needs --frames or --replay to end
+//   --egl              create the context through EGL (e.g. Mesa without GLX)
+//   --frames n         quit after n frames
+//   --capture dir      write the post-processed frames to dir as PPM images
+//   --capture-every n  only every n-th frame
+//   --trace path       write the recent Chrome trace to path on exit; F12 writes it any time
+struct LaunchOptions
+{
+    std::string recordPath;
+    std::string replayPath;
+    std::string timingsPath;
+    float timestep = 1.0f / 60.0f;
+    bool headless = false;
+    bool egl = false;
+    unsigned int frames = 0; // 0: until closed
+    std::string captureDirectory;
+    unsigned int captureEvery = 1;
+    std::string tracePath;
+};
+
+static bool ParseLaunchOptions(int argc, char** argv, LaunchOptions& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        bool hasValue = i + 1 < argc;
+        if (!std::strcmp(argv[i], "--record") && hasValue)
+            options.recordPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--replay") && hasValue)
+            options.replayPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--timings") && hasValue)
+            options.timingsPath = argv[++i];
+        else if (!std::strcmp(argv[i], "--timestep") && hasValue)
+            options.timestep = static_cast<float>(std::atof(argv[++i]));
+        else if (!std::strcmp(argv[i], "--headless"))
+            options.headless = true;
+        else if (!std::strcmp(argv[i], "--egl"))
+            options.egl = true;
+        else if (!std::strcmp(argv[i], "--frames") && hasValue)
+            options.frames = static_cast<unsigned int>(std::max(std::atoi(argv[++i]), 0));
+        else if (!std::strcmp(argv[i], "--capture") && hasValue)
+            options.captureDirectory = argv[++i];
+        else if (!std::strcmp(argv[i], "--capture-every") && hasValue)
+            options.captureEvery = static_cast<unsigned int>(std::max(std::atoi(argv[++i]), 1));
+        else if (!std::strcmp(argv[i], "--trace") && hasValue)
+            options.tracePath = argv[++i];
+        else
+        {
+            std::cout << "usage: " << argv[0]
+                << " [--record path] [--replay path] [--timings out.csv] [--timestep sec]"
+                << " [--headless] [--egl] [--frames n] [--capture dir] [--capture-every n] [--trace out.json]" << std::endl;
+            return false;
+        }
+    }
+    if (options.timestep <= 0.0f)
+        options.timestep = 1.0f / 60.0f;
+    // Nobody can close a hidden window
+    if (options.headless && !options.frames && options.replayPath.empty())
+    {
+        std::cout << "--headless needs --frames n or --replay path to know when to stop" << std::endl;
+        return false;
+    }
+    return true;
+}
+
 void framebufferSizeCallback(GLFWwindow* window, int newW, int newH)
 {
     width = newW;
     height = newH;
     glViewport(0, 0, width, height);
 
-    fboPtr->Resize(width, height);
+    if (fboPtr)
+        fboPtr->Resize(width, height);
  }
 
-int main(void)
+int main(int argc, char** argv)
 {
     GLFWwindow* window;
     Settings settings;
+    LaunchOptions options;
+    if (!ParseLaunchOptions(argc, argv, options))
+        return -1;
+
+    CameraPath cameraPath;
+    bool replaying = !options.replayPath.empty();
+    if (replaying && !cameraPath.Load(options.replayPath))
+        return -1;
+    // Replays and headless runs advance by a fixed step and measure the renderer,
+    // not the display or the scaler
+    bool fixedStep = replaying || options.headless;
+    if (fixedStep)
+    {
+        settings.VSync = false;
+        settings.dynamicResolution = false;
+    }
 
     /* Initialize the library */
     if (!glfwInit())
@@ -70,6 +176,14 @@ int main(void)
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // Headless: the window only provides the context, the frames go to FrameCapture's target
+    if (options.headless)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    if (options.egl)
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+#if GL_ERROR_CHECK == GL_ERROR_CHECK_CALLBACK && !defined(NDEBUG)
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
 
     /* Create a windowed mode window and its OpenGL context */
 
@@ -86,21 +200,35 @@ int main(void)
     glfwSetFramebufferSizeCallback(window, framebufferSizeCallback);
 
     /* create a valid OpenGL rendering context and call glewInit() to initialize the extension entry points*/
+    // Core profiles (Mesa in particular) do not list extensions the way GLEW expects;
+    // without this it leaves entry points such as glGenVertexArrays null
+    glewExperimental = GL_TRUE;
     if (glewInit() != GLEW_OK)
         return -1;
 
     std::cout << "OpenGL Version:\t" << glGetString(GL_VERSION) << std::endl;
+    InitGLDebugOutput();
+
+    // Let the driver compile and link on its own threads. Nothing polls GL_COMPLETION_STATUS_KHR,
+    // so this only overlaps programs that are submitted before the first of them is used
+    if (GLEW_KHR_parallel_shader_compile)
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
 
     /* ImGui Setup */
-    ImGui::CreateContext();
-    ImGui::StyleColorsDark();
-    ImGuiIO& io = ImGui::GetIO(); (void)io;
-    io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
-    io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
-    ImGui_ImplGlfw_InitForOpenGL(window, true);
-    ImGui_ImplOpenGL3_Init("#version 330 core");
+    if (!options.headless)
+    {
+        ImGui::CreateContext();
+        ImGui::StyleColorsDark();
+        ImGuiIO& io = ImGui::GetIO(); (void)io;
+        // Extra platform windows are of no use to an unattended replay (and may not exist offscreen)
+        if (!replaying)
+            io.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;
+        io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+        ImGui_ImplGlfw_InitForOpenGL(window, true);
+        ImGui_ImplOpenGL3_Init("#version 330 core");
+    }
     
-    GLCall(glEnable(GL_BLEND));
+    GLState::Enable(GL_BLEND);
     GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
     
     {
@@ -118,69 +246,119 @@ int main(void)
         glm::mat4 view = camera.GetView();
         glm::mat4 proj = camera.GetProjection();
 
-        //Basic shader
-        std::vector<std::shared_ptr<Shader>> allShaders;
-        std::shared_ptr<Shader> shader = std::make_shared<Shader>("res/shaders/Basic.shader");
-        allShaders.emplace_back(shader);
-        shader->Bind();
         // Uniforms
         glm::vec3 lightPos{ 100.0f,300.0f,200.0f };
         glm::vec3 lightDir{ -1.0f, -3.0f, -2.0f };
         float lightIntensity = 3.0f;
-        shader->SetUniform1f("u_LightIntensity", lightIntensity);
         float Kd = 0.3f; //diffuse K
-        shader->SetUniform1f("u_Kd", Kd);
         float Ks = 0.05f; //specular K
-        shader->SetUniform1f("u_Ks", Ks);
 
         // Texture
         Texture texture("res/textures/23w31a_blocks.png-atlas.png");
         texture.Bind();
-        shader->SetUniform1i("u_Texture", 0);
 
-        // Shadow Map shader
+        // Programs without variants are created first. Their compile and link are checked at
+        // their first Bind() below, so they may overlap the first Basic variant but no more
         std::shared_ptr<Shader> shadowShader = std::make_shared<Shader>("res/shaders/Shadow.shader");
+        std::shared_ptr<Shader> depthPrepassShader = std::make_shared<Shader>("res/shaders/Shadow.shader",
+            std::vector<std::string>{ "DEPTH_PREPASS" });
+        std::shared_ptr<Shader> waterShader = std::make_shared<Shader>("res/shaders/Water.shader");
+        std::shared_ptr<Shader> blurShader = std::make_shared<Shader>("res/shaders/GaussianBlur.shader");
+        std::shared_ptr<Shader> bloomShader = std::make_shared<Shader>("res/shaders/Bloom.shader");
+
+        // Setup shared by the scene shaders and every variant compiled from them
+        auto sceneSetup = [](Shader& sceneShader)
+        {
+            sceneShader.SetUniform1i("u_Texture", 0);
+            if (sceneShader.HasUniform("u_ShadowMap"))
+                sceneShader.SetUniform1i("u_ShadowMap", 1);
+            if (sceneShader.HasUniform("u_MomentsMap"))
+                sceneShader.SetUniform1i("u_MomentsMap", 2);
+            sceneShader.BindUniformBlock("PerFrame", PER_FRAME_BINDING);
+            sceneShader.BindUniformBlock("Material", MATERIAL_BINDING);
+        };
+
+        //Basic shader
+        // Shadow settings select compiled variants instead of branching per fragment
+        const std::vector<std::string> shadowFeatures{ "USE_SHADOW", "USE_PCF", "USE_PCSS", "USE_VSM" };
+        ShaderVariants basicVariants("res/shaders/Basic.shader", shadowFeatures, sceneSetup);
+        std::vector<std::shared_ptr<Shader>> allShaders;
+        bool usePCF = settings.Shadow && settings.PCF;
+        bool usePCSS = settings.Shadow && !settings.PCF && settings.PCSS;
+        bool useVSM = settings.Shadow && !settings.PCF && !settings.PCSS && settings.VSM;
+        bool momentsWritten = false;
+        allShaders.emplace_back(basicVariants.Get({ settings.Shadow, usePCF, usePCSS, useVSM }));
+
+        // Shadow Map shader
         //Shaders.emplace_back(shadowShader);
         shadowShader->Bind();
-        // Uniforms
-        float near_plane = 0.1f, far_plane = 200.0f;
-        glm::mat4 lightProjection = glm::ortho(-40.0f, 40.0f, -40.0f, 40.0f, near_plane, far_plane);
-        glm::mat4 lightView = glm::lookAt(lightPos, lightPos + lightDir, glm::vec3(0.0, 1.0, 0.0));
-        glm::mat4 lightSpaceMatrix = lightProjection * lightView;
-        shadowShader->SetUniformMat4f("u_Model", model);
-        shadowShader->SetUniformMat4f("u_LightPV", lightSpaceMatrix);
+        sceneSetup(*shadowShader);
+        UniformHandle cascadeUniform = shadowShader->GetUniform("u_Cascade");
         shadowShader->Unbind();
+        // Depth pre-pass shader
+        depthPrepassShader->Bind();
+        sceneSetup(*depthPrepassShader);
+        // Cascades: half extents in blocks, nearest first; depth reaches 100 blocks past each box
+        const float cascadeRadii[SHADOW_CASCADES] = { 12.0f, 32.0f, 80.0f, 200.0f };
+        ShadowCascades cascades(cascadeRadii, 100.0f);
 
         // BillBoard shader
-        std::shared_ptr<Shader> billBoardShader = std::make_shared<Shader>("res/shaders/BillBoard.shader");
-        allShaders.emplace_back(billBoardShader);
-        billBoardShader->Bind();
-        billBoardShader->SetUniform1f("u_LightIntensity", lightIntensity);
-        billBoardShader->SetUniform1f("u_Kd", Kd);
-        billBoardShader->SetUniform1f("u_Ks", Ks);
-        billBoardShader->SetUniform1i("u_Texture", 0);
+        ShaderVariants billBoardVariants("res/shaders/BillBoard.shader", shadowFeatures, sceneSetup);
+        allShaders.emplace_back(billBoardVariants.Get({ settings.Shadow, usePCF, usePCSS, useVSM }));
 
         // Water shader
-        std::shared_ptr<Shader> waterShader = std::make_shared<Shader>("res/shaders/Water.shader");
         allShaders.emplace_back(waterShader);
         waterShader->Bind();
-        waterShader->SetUniform1f("u_LightIntensity", lightIntensity);
-        waterShader->SetUniform1f("u_Kd", Kd);
-        waterShader->SetUniform1f("u_Ks", Ks);
-        waterShader->SetUniform1i("u_Texture", 0);
+        sceneSetup(*waterShader);
+
+        // Uniform buffers shared by the scene shaders
+        UniformBuffer perFrameUBO(sizeof(PerFrameUniforms), PER_FRAME_BINDING);
+        UniformBuffer materialUBO(sizeof(MaterialUniforms), MATERIAL_BINDING);
+        MaterialUniforms material{ lightIntensity, Kd, Ks, 0.0f };
+        materialUBO.SetData(&material, sizeof(MaterialUniforms));
+        PerFrameUniforms perFrame{};
 
         // Post-Processing FBO
-        std::shared_ptr<Shader> frameBufferShader = std::make_shared<Shader>("res/shaders/FrameBuffer.shader");
         static FrameBuffer fbo(width, height);
-        fboPtr = std::make_shared<FrameBuffer>(fbo);
-
-        frameBufferShader->Bind();
-        frameBufferShader->SetUniform1i("screenTexture", fbo.GetFBOTexture()[0]);
-        frameBufferShader->SetUniform1i("brightTexture", fbo.GetBlurTexture());
-        frameBufferShader->SetUniform1i("depthTexture", fbo.GetDepthTexture());
+        // Not a copy: the resize callback has to update the mip sizes of this very object
+        fboPtr = &fbo;
+        RenderScale renderScale(settings.targetFrameTime / 1000.0f);
+
+        // Post-processing effects are compile-time variants as well
+        ShaderVariants frameBufferVariants("res/shaders/FrameBuffer.shader",
+            { "USE_BLOOM", "UNDERWATER", "USE_FOG", "TONEMAP_REINHARD", "TONEMAP_CE", "TONEMAP_FILMIC", "TONEMAP_ACES" },
+            [](Shader& postShader)
+            {
+                postShader.SetUniform1i("screenTexture", fbo.GetFBOTexture());
+                if (postShader.HasUniform("brightTexture"))
+                    postShader.SetUniform1i("brightTexture", fbo.GetBlurTexture());
+                if (postShader.HasUniform("depthTexture"))
+                    postShader.SetUniform1i("depthTexture", fbo.GetDepthTexture());
+            });
+        // Per-frame post-processing uniforms, resolved whenever the variant changes
+        struct PostProcessUniforms
+        {
+            UniformHandle brightness, contrast, saturation, gamma, exposure;
+        } post;
+        std::shared_ptr<Shader> frameBufferShader;
 
-        // Gaussian Blur shader
-        std::shared_ptr<Shader> blurShader = std::make_shared<Shader>("res/shaders/GaussianBlur.shader");
+        // Recording and replay of the camera path, frame capture
+        FrameTimings frameTimings;
+        if (fixedStep)
+        {
+            // The path (or nothing) drives the camera; input would only add noise to the run
+            camera.SetInput(nullptr);
+            if (!options.timingsPath.empty())
+                frameTimings.Open(options.timingsPath);
+        }
+        FrameCapture frameCapture;
+        frameCapture.SetDirectory(options.captureDirectory);
+        bool capturing = !options.captureDirectory.empty();
+        unsigned int frameIndex = 0;
+        Profiler profiler;
+        bool traceKeyDown = false;
+        float recordStart = static_cast<float>(glfwGetTime());
+        lastFrameTime = recordStart;
 
         /* Loop until the user closes the window */
         while (!glfwWindowShouldClose(window))
@@ -190,258 +368,444 @@ int main(void)
             deltaTime = currentTime - lastFrameTime;
             lastFrameTime = currentTime;
             camera.OnResize(width, height);
-            camera.OnUpdate(settings.cameraSpeed * deltaTime);
+            if (options.frames && frameIndex >= options.frames)
+            {
+                glfwSetWindowShouldClose(window, GLFW_TRUE);
+                break;
+            }
+            if (fixedStep)
+            {
+                // Fixed timestep: frame n always shows the pose at n * timestep
+                float stepTime = frameIndex * options.timestep;
+                if (replaying)
+                {
+                    if (stepTime > cameraPath.GetDuration())
+                    {
+                        glfwSetWindowShouldClose(window, GLFW_TRUE);
+                        break;
+                    }
+                    CameraPose pose = cameraPath.Sample(stepTime);
+                    camera.SetPose(pose.position, pose.direction);
+                }
+                deltaTime = options.timestep;
+                frameTimings.BeginFrame(stepTime, camera.GetPosition().x, camera.GetPosition().y, camera.GetPosition().z);
+            }
+            else
+            {
+                camera.OnUpdate(settings.cameraSpeed * deltaTime);
+                if (!options.recordPath.empty())
+                    cameraPath.Record(currentTime - recordStart, camera.GetPosition(), camera.GetDirection());
+            }
             glfwSwapInterval(settings.VSync ? 1 : 0);
 
+            // Dynamic resolution: the scene gives up pixels before the frame misses its target
+            renderScale.SetTargetFrameTime(settings.targetFrameTime / 1000.0f);
+            fbo.SetRenderScale(settings.dynamicResolution ? renderScale.Update(deltaTime) : 1.0f);
+            FrameBufferFormat targetFormat;
+            if (!settings.compactTargets)
+            {
+                targetFormat.color = GL_RGB16F;
+                targetFormat.depth = GL_DEPTH_COMPONENT32F;
+                targetFormat.bloom = GL_RGB16F;
+            }
+            fbo.SetFormat(targetFormat);
+
+            Trace::Begin("Frame");
+            // Dump the trace on the press of F12, not on every frame it is held
+            bool traceKey = !options.headless && glfwGetKey(window, GLFW_KEY_F12) == GLFW_PRESS;
+            if (traceKey && !traceKeyDown)
+                Trace::Dump(options.tracePath.empty() ? "trace.json" : options.tracePath);
+            traceKeyDown = traceKey;
+
+            // ImGui (and its extra viewports) changed GL state behind the cache last frame
+            GLState::Invalidate();
+            GLState::ResetFrameStats();
+            RenderStats::ResetFrame();
+            AllocTracker::BeginFrame();
+            AllocTracker::SetCurrentTag(AllocTag::Render);
+            profiler.BeginFrame();
+
             /* Render here */
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+            // Settings changes pick (and on first use compile) the matching variants
+            usePCF = settings.Shadow && settings.PCF;
+            usePCSS = settings.Shadow && !settings.PCF && settings.PCSS;
+            useVSM = settings.Shadow && !settings.PCF && !settings.PCSS && settings.VSM;
+            allShaders[0] = basicVariants.Get({ settings.Shadow, usePCF, usePCSS, useVSM });
+            allShaders[1] = billBoardVariants.Get({ settings.Shadow, usePCF, usePCSS, useVSM });
+
+            profiler.Begin(ProfileStage::WorldUpdate);
+            AllocTracker::SetCurrentTag(AllocTag::World);
             if(world.GetRenderDistance() != renderDistance)
                 world.SetRenderDistance(renderDistance);
             world.Update(allShaders, camera.GetPosition());
             auto chunkData = world.GetChunkData();
+            RenderStats::Get().chunkQueue = static_cast<unsigned int>(world.GetQueueLength());
+            AllocTracker::SetCurrentTag(AllocTag::Render);
+            profiler.End(ProfileStage::WorldUpdate);
 
-            unsigned int DepthFBO = 0;
             unsigned int DepthMapID = 0;
             glm::uvec3 currentChunkPos = world.GetCurrentChunkPos();
             std::pair<int, int> currentChunkXZ{ currentChunkPos.x, currentChunkPos.z };
             if (chunkData.find(currentChunkXZ) != chunkData.end())
             {
                 std::shared_ptr<Renderer> renderer = chunkData.at(currentChunkXZ)->GetRenderer();
-                DepthFBO = renderer->GetDepthMapFBO();
                 DepthMapID = renderer->GetDepthMap();
             }
 
+            //Uniforms
+            model = glm::translate(glm::mat4{ 1.0 }, translation);
+            view = camera.GetView();
+            proj = camera.GetProjection();
+            unsigned int cascadeMask = 0;
+            unsigned int shadowTexelsRedrawn = 0;
+            std::vector<std::pair<glm::vec3, glm::vec3>> changedChunks = world.TakeChangedBounds();
+            if (useVSM != momentsWritten && Renderer::GetDepthMapFBO() != 0)
+            {
+                // Moments are only written while VSM is on, so switching it on needs a full redraw
+                Renderer::SetShadowMoments(useVSM);
+                momentsWritten = useVSM;
+                cascades.Invalidate();
+            }
             if (settings.Shadow)
             {
-                glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
-                glBindFramebuffer(GL_FRAMEBUFFER, DepthFBO);
-                glClear(GL_DEPTH_BUFFER_BIT);
-                for (auto entry : chunkData)
+                lightPos = camera.GetPosition() + glm::vec3(0.0f, 10.0f, 0.0f) + lightDir * glm::vec3(-10.0);
+                cascades.Update(camera.GetPosition(), lightDir);
+                // Loaded, dropped or regenerated chunks only dirty the part of a cascade they cover
+                for (auto& bounds : changedChunks)
+                    cascades.MarkDirty(bounds.first, bounds.second);
+                cascadeMask = cascades.TakeDirty();
+            }
+            else
+            {
+                // The atlas goes stale while shadows are off
+                cascades.Invalidate();
+            }
+
+            // One upload serves every pass and shader this frame
+            perFrame.model = model;
+            perFrame.view = view;
+            perFrame.proj = proj;
+            for (int cascade = 0; cascade < SHADOW_CASCADES; cascade++)
+                perFrame.lightPV[cascade] = cascades.GetLightPV(cascade);
+            perFrame.cameraPos = camera.GetPosition();
+            perFrame.time = currentTime;
+            perFrame.lightPos = lightPos;
+            perFrame.waterGeometry = settings.waterGeometry;
+            perFrameUBO.SetData(&perFrame, sizeof(PerFrameUniforms));
+
+            profiler.Begin(ProfileStage::Shadow);
+            if (cascadeMask != 0 && Renderer::GetDepthMapFBO() != 0)
+            {
+                shadowShader->Bind();
+                texture.Bind(0);
+                for (int cascade = 0; cascade < SHADOW_CASCADES; cascade++)
                 {
-                    auto currentChunk = entry.second;
-                    std::shared_ptr<Renderer> renderer = currentChunk->GetRenderer();
-
-                    // ShadowMap : First pass
-                    shadowShader->Bind();
-                    renderer->ChangeShader(shadowShader);
-                    // Uniforms
-                    lightPos = camera.GetPosition() + glm::vec3(0.0f, 10.0f, 0.0f) + lightDir * glm::vec3(-10.0);
-                    lightView = glm::lookAt(lightPos, lightPos + lightDir, glm::vec3(0.0, 1.0, 0.0));
-                    lightSpaceMatrix = lightProjection * lightView;
-                    shadowShader->SetUniformMat4f("u_LightPV", lightSpaceMatrix);
-                    texture.Bind(0);
-                    renderer->Draw();
+                    if (!(cascadeMask & (1u << cascade)))
+                        continue;
+
+                    // ShadowMap : First pass, into the dirty part of this cascade's atlas tile
+                    int x, y, w, h;
+                    cascades.GetScissor(cascade, x, y, w, h);
+                    Renderer::BeginShadowCascade(cascade, x, y, w, h);
+                    shadowTexelsRedrawn += w * h;
+                    shadowShader->SetUniform1i(cascadeUniform, cascade);
+                    for (auto entry : chunkData)
+                    {
+                        std::shared_ptr<Renderer> renderer = entry.second->GetRenderer();
+                        if (!cascades.Overlaps(cascade, renderer->GetBoundsMin(), renderer->GetBoundsMax()))
+                            continue;
+                        RenderStats::CountShadowChunk();
+                        renderer->ChangeShader(shadowShader);
+                        renderer->Draw(Renderer::FacesTowardsDirection(lightDir));
+                    }
+                    if (momentsWritten)
+                    {
+                        Renderer::BlurShadowMoments(blurShader, cascade, x, y, w, h);
+                        shadowShader->Bind();
+                        texture.Bind(0);
+                    }
                 }
+                Renderer::EndShadowPass();
             }
-            else {
-                glBindFramebuffer(GL_FRAMEBUFFER, DepthFBO);
-                glClear(GL_DEPTH_BUFFER_BIT);
-            }
+            profiler.End(ProfileStage::Shadow);
 
+            profiler.Begin(ProfileStage::Opaque);
             fbo.Bind();
-            glViewport(0, 0, width, height);
+            glViewport(0, 0, fbo.GetWidth(), fbo.GetHeight());
             glm::vec3 backgroundColor = glm::mix(glm::vec3(0.67f, 0.90f, 0.90f), glm::vec3(1.0f, 0.8f, 0.3f), (glm::normalize(lightDir).y + 1.0f) * 0.5f);
             glClearColor(backgroundColor.r, backgroundColor.g, backgroundColor.b, 1.0f);
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-            glEnable(GL_DEPTH_TEST);
+            GLState::Enable(GL_DEPTH_TEST);
 
-            //Uniforms
-            model = glm::translate(glm::mat4{ 1.0 }, translation);
-            view = camera.GetView();
-            proj = camera.GetProjection();
 
-            // Basic Shader
-            shader->Bind();
-            shader->SetUniform1i("u_ShadowMap", 1);
-            shader->SetUniformMat4f("u_Model", model);
-            shader->SetUniformMat4f("u_View", view);
-            shader->SetUniformMat4f("u_Proj", proj);
-            shader->SetUniform3f("u_CameraPos", camera.GetPosition());
-            shader->SetUniformMat4f("u_LightPV", lightSpaceMatrix);
-            shader->SetUniform3f("u_LightPos", lightPos);
-            shader->SetUniform1i("show_Shadow", settings.Shadow);
-            shader->SetUniform1i("show_PCF", settings.PCF);
-            shader->SetUniform1i("show_PCSS", settings.PCSS);
-
-            // BillBoard shader
-            billBoardShader->Bind();
-            billBoardShader->SetUniform1i("u_ShadowMap", 1);
-            billBoardShader->SetUniformMat4f("u_Model", model);
-            billBoardShader->SetUniformMat4f("u_View", view);
-            billBoardShader->SetUniformMat4f("u_Proj", proj);
-            billBoardShader->SetUniform3f("u_CameraPos", camera.GetPosition());
-            billBoardShader->SetUniformMat4f("u_LightPV", lightSpaceMatrix);
-            billBoardShader->SetUniform3f("u_LightPos", lightPos);
-            billBoardShader->SetUniform1i("show_Shadow", settings.Shadow);
-            billBoardShader->SetUniform1i("show_PCF", settings.PCF);
-            billBoardShader->SetUniform1i("show_PCSS", settings.PCSS);
-
-            // Water shader
-            waterShader->Bind();
-            waterShader->SetUniformMat4f("u_Model", model);
-            waterShader->SetUniformMat4f("u_View", view);
-            waterShader->SetUniformMat4f("u_Proj", proj);
-            waterShader->SetUniform3f("u_CameraPos", camera.GetPosition());
-            waterShader->SetUniform3f("u_LightPos", lightPos);
-            waterShader->SetUniform1f("time", currentTime);
-            waterShader->SetUniform1i("waterGeometry", settings.waterGeometry);
+            // Chunks in the camera view, opaque ones nearest first so early-Z rejects what they hide
+            glm::mat4 viewProj = proj * view * model;
+            std::vector<std::shared_ptr<Renderer>> renderers;
+            renderers.reserve(chunkData.size());
+            for (auto entry : chunkData)
+            {
+                std::shared_ptr<Renderer> renderer = entry.second->GetRenderer();
+                bool visible = renderer->InView(viewProj);
+                RenderStats::CountChunk(visible);
+                if (visible)
+                    renderers.push_back(renderer);
+            }
+            Renderer::SortFrontToBack(renderers, camera.GetPosition());
 
-            // Frame Shader
-            frameBufferShader->Bind();
-            frameBufferShader->SetUniform1f("brightness", settings.brightness);
-            frameBufferShader->SetUniform1f("contrast", settings.contrast);
-            frameBufferShader->SetUniform1f("saturation", settings.saturation);
-            frameBufferShader->SetUniform1f("gamma", settings.gamma);
-            frameBufferShader->SetUniform1f("exposure", settings.exposure);
-            frameBufferShader->SetUniform1i("foggy", settings.foggy);
-            frameBufferShader->SetUniform1i("bloom", settings.bloom);
-            frameBufferShader->SetUniform1i("reinhard", settings.reinhard);
-            frameBufferShader->SetUniform1i("ce", settings.ce);
-            frameBufferShader->SetUniform1i("filmic", settings.filmic);
-            frameBufferShader->SetUniform1i("aces", settings.aces);
+            texture.Bind(0);
+            if (settings.depthPrepass)
+            {
+                // Depth only; the lighting pass below then shades each pixel once
+                glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+                for (auto& renderer : renderers)
+                {
+                    renderer->ChangeShader(depthPrepassShader);
+                    renderer->Draw(renderer->FacesTowards(camera.GetPosition()));
+                }
+                glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+                GLState::DepthFunc(GL_EQUAL);
+                GLState::DepthMask(false);
+            }
 
             // ShadowMap : Second pass
-            for (auto entry : chunkData)
+            for (auto& renderer : renderers)
             {
-                auto currentChunk = entry.second;
-                std::shared_ptr<Renderer> renderer = currentChunk->GetRenderer();
                 renderer->ChangeShader(allShaders);
-                glActiveTexture(GL_TEXTURE1);
-                glBindTexture(GL_TEXTURE_2D, renderer->GetDepthMap());
+                GLState::BindTexture(1, renderer->GetDepthMap());
+                GLState::BindTexture(2, Renderer::GetMomentsMap());
 
-                renderer->Draw();
+                renderer->Draw(renderer->FacesTowards(camera.GetPosition()));
             }
-            for (auto entry : chunkData)
-            {
-                auto currentChunk = entry.second;
-                std::shared_ptr<Renderer> renderer = currentChunk->GetRenderer();
+            GLState::DepthFunc(GL_LESS);
+            GLState::DepthMask(true);
+            profiler.End(ProfileStage::Opaque);
 
-                renderer->DrawWater();
-            }
+            profiler.Begin(ProfileStage::Water);
+            Renderer::DrawWater(renderers, camera.GetPosition());
+            profiler.End(ProfileStage::Water);
 
             if (settings.bloom)
-                fbo.GaussianBlur(10, blurShader);
+            {
+                ProfileScope blurScope(profiler, ProfileStage::Blur);
+                fbo.Bloom(bloomShader);
+            }
+
+            // Frame Shader
+            profiler.Begin(ProfileStage::Composite);
+            bool underwater = world.GetBlockType(camera.GetPosition()) == BlockType::Water;
+            std::shared_ptr<Shader> postVariant = frameBufferVariants.Get({ settings.bloom, underwater, settings.foggy,
+                settings.reinhard, settings.ce, settings.filmic, settings.aces });
+            if (postVariant != frameBufferShader)
+            {
+                frameBufferShader = postVariant;
+                post.brightness = frameBufferShader->GetUniform("brightness");
+                post.contrast = frameBufferShader->GetUniform("contrast");
+                post.saturation = frameBufferShader->GetUniform("saturation");
+                post.gamma = frameBufferShader->GetUniform("gamma");
+                // Only the tonemapping variants read exposure
+                post.exposure = frameBufferShader->HasUniform("exposure") ? frameBufferShader->GetUniform("exposure") : UniformHandle();
+            }
             frameBufferShader->Bind();
-            if (world.GetBlockType(camera.GetPosition()) == BlockType::Water)
-                frameBufferShader->SetUniform1i("underwater", 1);
-            else
-                frameBufferShader->SetUniform1i("underwater", 0);
-            fbo.Render();
+            frameBufferShader->SetUniform1f(post.brightness, settings.brightness);
+            frameBufferShader->SetUniform1f(post.contrast, settings.contrast);
+            frameBufferShader->SetUniform1f(post.saturation, settings.saturation);
+            frameBufferShader->SetUniform1f(post.gamma, settings.gamma);
+            frameBufferShader->SetUniform1f(post.exposure, settings.exposure);
+            // Headless frames never reach a window; the capture target stands in for it
+            if (options.headless || capturing)
+                frameCapture.Resize(width, height);
+            unsigned int outputFBO = options.headless ? frameCapture.GetTarget() : 0;
+            fbo.Render(outputFBO);
+            if (capturing && frameIndex % options.captureEvery == 0)
+                frameCapture.Capture(outputFBO, frameIndex);
+            profiler.End(ProfileStage::Composite);
           
-            ImGui_ImplOpenGL3_NewFrame();
-            ImGui_ImplGlfw_NewFrame();
-            ImGui::NewFrame();
+            if (!options.headless)
             {
-                ImGui::Begin("Model Configs");
-                ImGui::DragFloat3("Light Direction", glm::value_ptr(lightDir), 0.1f);
-                ImGui::Checkbox("Shadow    ", &settings.Shadow);
-                if (settings.Shadow)
+                ProfileScope imguiScope(profiler, ProfileStage::ImGui);
+                AllocScope imguiAllocScope(AllocTag::ImGui);
+                ImGui_ImplOpenGL3_NewFrame();
+                ImGui_ImplGlfw_NewFrame();
+                ImGui::NewFrame();
                 {
-                    ImGui::SameLine();
-                    ImGui::Checkbox("PCF   ", &settings.PCF);
-                    if (settings.PCF)
-                        settings.PCSS = false;
-                    ImGui::SameLine();
-                    ImGui::Checkbox("PCSS", &settings.PCSS);
-                    if (settings.PCSS)
-                        settings.PCF = false;
+                    ImGui::Begin("Model Configs");
+                    ImGui::DragFloat3("Light Direction", glm::value_ptr(lightDir), 0.1f);
+                    ImGui::Checkbox("Shadow    ", &settings.Shadow);
+                    if (settings.Shadow)
+                    {
+                        ImGui::SameLine();
+                        ImGui::Checkbox("PCF   ", &settings.PCF);
+                        if (settings.PCF)
+                            settings.PCSS = settings.VSM = false;
+                        ImGui::SameLine();
+                        ImGui::Checkbox("PCSS", &settings.PCSS);
+                        if (settings.PCSS)
+                            settings.PCF = settings.VSM = false;
+                        ImGui::SameLine();
+                        ImGui::Checkbox("VSM", &settings.VSM);
+                        if (settings.VSM)
+                            settings.PCF = settings.PCSS = false;
+                    }
+                    ImGui::DragInt("Render Distance", &renderDistance, 1, 1, 8);
+                    ImGui::DragFloat("Camera Speed", &settings.cameraSpeed, 0.1f, 0.0f, std::numeric_limits<float>::max());
+                    ImGui::Text("Camera Position: (%f, %f, %f)", 
+                        camera.GetPosition().x, camera.GetPosition().y, camera.GetPosition().z);
+                    ImGui::Checkbox("VSync", &settings.VSync);
+                    ImGui::Text("FPS: %.0f Hz", 1 / deltaTime);
+                    ImGui::Text("Rendering Time: %.0f ms", deltaTime * 1000);
+                    ImGui::Checkbox("Dynamic Resolution", &settings.dynamicResolution);
+                    ImGui::DragFloat("Target Frame Time (ms)", &settings.targetFrameTime, 0.1f, 1.0f, 100.0f);
+                    ImGui::Text("Render Scale: %.0f%% (%d x %d)", fbo.GetRenderScale() * 100.0f, fbo.GetWidth(), fbo.GetHeight());
+                    ImGui::Checkbox("Compact HDR Targets", &settings.compactTargets);
+                    ImGui::Checkbox("Depth Pre-Pass", &settings.depthPrepass);
+                    ImGui::Text("Offscreen Targets: %.1f MB VRAM, ~%.1f MB/frame",
+                        fbo.GetMemoryBytes() / (1024.0 * 1024.0), fbo.GetFrameTrafficBytes(settings.bloom) / (1024.0 * 1024.0));
+                    ImGui::Text("Loaded Chunks: %d", world.GetChunkData().size());
+                    ImGui::Text("GL State Calls: %u issued, %u suppressed",
+                        GLState::GetFrameStats().issued, GLState::GetFrameStats().suppressed);
+                    ImGui::Text("Shadow Texels Redrawn: %.1f%%", 100.0f * shadowTexelsRedrawn / (SHADOW_WIDTH * SHADOW_HEIGHT));
+                    // Shadow map fetches per shaded fragment; PCSS runs a blocker search before filtering
+                    int shadowFetches = !settings.Shadow ? 0 : usePCF ? SHADOW_FILTER_SAMPLES : usePCSS ? 2 * SHADOW_FILTER_SAMPLES : 1;
+                    ImGui::Text("Shadow Cost: %d fetches per fragment%s", shadowFetches,
+                        momentsWritten ? " + moments blur" : "");
+                    ImGui::Text("Shader Variants: %u compiled", basicVariants.GetCompiledCount()
+                        + billBoardVariants.GetCompiledCount() + frameBufferVariants.GetCompiledCount());
+                    ImGui::Checkbox("Geometry Shader Test", &settings.waterGeometry);
+                    ImGui::End();
                 }
-                ImGui::DragInt("Render Distance", &renderDistance, 1, 1, 8);
-                ImGui::DragFloat("Camera Speed", &settings.cameraSpeed, 0.1f, 0.0f, std::numeric_limits<float>::max());
-                ImGui::Text("Camera Position: (%f, %f, %f)", 
-                    camera.GetPosition().x, camera.GetPosition().y, camera.GetPosition().z);
-                ImGui::Checkbox("VSync", &settings.VSync);
-                ImGui::Text("FPS: %.0f Hz", 1 / deltaTime);
-                ImGui::Text("Rendering Time: %.0f ms", deltaTime * 1000);
-                ImGui::Text("Loaded Chunks: %d", world.GetChunkData().size());
-                ImGui::Checkbox("Geometry Shader Test", &settings.waterGeometry);
-                ImGui::End();
-            }
-            {
-                ImGui::Begin("Post Processing Settings");
                 {
-                    ImGui::Checkbox("Screen Space Fog", &settings.foggy);
-                    ImGui::SameLine();
-                    ImGui::Checkbox("Bloom", &settings.bloom);
-                    ImGui::DragFloat("Brightness", &settings.brightness, 0.01f);
-                    ImGui::DragFloat("Contrast", &settings.contrast, 0.01f);
-                    ImGui::DragFloat("Saturation", &settings.saturation, 0.01f);
-                    ImGui::DragFloat("Gamma Correction", &settings.gamma, 0.01f);
-                    ImGui::Checkbox("Tone Mapping    ", &settings.toneMapping);
-                    if (settings.toneMapping)
+                    ImGui::Begin("Post Processing Settings");
                     {
-                        ImGui::Checkbox("Reinhard  ", &settings.reinhard);
-                        if (settings.reinhard)
-                        {
-                            settings.aces = false;
-                            settings.ce = false;
-                            settings.filmic = false;
-                        }
-                        ImGui::SameLine();
-                        ImGui::Checkbox("CryEngine  ", &settings.ce);
-                        if (settings.ce)
-                        {
-                            settings.reinhard = false;
-                            settings.filmic = false;
-                            settings.aces = false;
-                        }
+                        ImGui::Checkbox("Screen Space Fog", &settings.foggy);
                         ImGui::SameLine();
-                        ImGui::Checkbox("Filmic", &settings.filmic);
-                        if (settings.filmic)
+                        ImGui::Checkbox("Bloom", &settings.bloom);
+                        ImGui::DragFloat("Brightness", &settings.brightness, 0.01f);
+                        ImGui::DragFloat("Contrast", &settings.contrast, 0.01f);
+                        ImGui::DragFloat("Saturation", &settings.saturation, 0.01f);
+                        ImGui::DragFloat("Gamma Correction", &settings.gamma, 0.01f);
+                        ImGui::Checkbox("Tone Mapping    ", &settings.toneMapping);
+                        if (settings.toneMapping)
                         {
-                            settings.reinhard = false;
-                            settings.ce = false;
-                            settings.aces = false;
+                            ImGui::Checkbox("Reinhard  ", &settings.reinhard);
+                            if (settings.reinhard)
+                            {
+                                settings.aces = false;
+                                settings.ce = false;
+                                settings.filmic = false;
+                            }
+                            ImGui::SameLine();
+                            ImGui::Checkbox("CryEngine  ", &settings.ce);
+                            if (settings.ce)
+                            {
+                                settings.reinhard = false;
+                                settings.filmic = false;
+                                settings.aces = false;
+                            }
+                            ImGui::SameLine();
+                            ImGui::Checkbox("Filmic", &settings.filmic);
+                            if (settings.filmic)
+                            {
+                                settings.reinhard = false;
+                                settings.ce = false;
+                                settings.aces = false;
+                            }
+                            ImGui::SameLine();
+                            ImGui::Checkbox("ACES", &settings.aces);
+                            if (settings.aces)
+                            {
+                                settings.reinhard = false;
+                                settings.ce = false;
+                                settings.filmic = false;
+                            }
+                            ImGui::DragFloat("HDR Exposure", &settings.exposure, 0.01f);
                         }
-                        ImGui::SameLine();
-                        ImGui::Checkbox("ACES", &settings.aces);
-                        if (settings.aces)
-                        {
+                        else {
                             settings.reinhard = false;
                             settings.ce = false;
                             settings.filmic = false;
+                            settings.aces = false;
                         }
-                        ImGui::DragFloat("HDR Exposure", &settings.exposure, 0.01f);
                     }
-                    else {
-                        settings.reinhard = false;
-                        settings.ce = false;
-                        settings.filmic = false;
-                        settings.aces = false;
+                    ImGui::End();
+                }
+                {
+                    ImGui::Begin("Shadow Map Texture");
+                    ImGui::Image((void*)(intptr_t)DepthMapID, ImVec2(512, 512), ImVec2(0.0f, 1.0f), ImVec2(1.0f, 0.0f)); // 趨ʾС
+                    ImGui::End();
+                }
+                {
+                    ImGui::Begin("Frame Buffer Texture");
+                    ImGui::Image((void*)(intptr_t)fbo.GetFBOTexture(), ImVec2(512, 288), ImVec2(0.0f, 1.0f), ImVec2(1.0f, 0.0f)); // 趨ʾС
+                    ImGui::End();
+                }
+                {
+                    // Counted up to here: the ImGui draws themselves are not included
+                    const RenderStatsCounters& stats = RenderStats::Get();
+                    ImGui::Begin("Render Stats");
+                    ImGui::Text("Draw Calls: %u", stats.drawCalls);
+                    ImGui::Text("Triangles: %llu", stats.triangles);
+                    ImGui::Text("Binds: %u programs, %u VAOs, %u textures", stats.programBinds, stats.vaoBinds, stats.textureBinds);
+                    ImGui::Text("Uniform Uploads: %u", stats.uniformUploads);
+                    ImGui::Text("Buffer Uploads: %.1f KB", stats.bufferBytes / 1024.0);
+                    ImGui::Text("Chunks: %u in view, %u culled", stats.chunksVisible, stats.chunksCulled);
+                    ImGui::Text("Shadow Chunk Draws: %u", stats.shadowChunkDraws);
+                    ImGui::Text("Chunk Queue: %u", stats.chunkQueue);
+                    ImGui::End();
+                }
+                {
+                    // Last complete frame, by the subsystem that asked for the memory
+                    ImGui::Begin("Allocations");
+                    if (!AllocTracker::IsEnabled())
+                        ImGui::Text("Build with TRACK_ALLOCATIONS=1 to count allocations");
+                    for (int tag = 0; AllocTracker::IsEnabled() && tag < (int)AllocTag::UNDIFINED; tag++)
+                    {
+                        AllocCounters frame = AllocTracker::GetFrame(AllocTag(tag));
+                        AllocCounters total = AllocTracker::GetTotal(AllocTag(tag));
+                        ImGui::Text("%-15s %6llu allocs %9.1f KB/frame   %9llu allocs %9.1f MB total",
+                            AllocTracker::GetTagName(AllocTag(tag)), frame.allocations, frame.bytes / 1024.0,
+                            total.allocations, total.bytes / (1024.0 * 1024.0));
                     }
+                    ImGui::End();
+                }
+                profiler.DrawPanel();
+                ImGui::Render();
+                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+                if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+                {
+                    GLFWwindow* backup_current_context = glfwGetCurrentContext();
+                    ImGui::UpdatePlatformWindows();
+                    ImGui::RenderPlatformWindowsDefault();
+                    glfwMakeContextCurrent(backup_current_context);
                 }
-                ImGui::End();
-            }
-            {
-                ImGui::Begin("Shadow Map Texture");
-                ImGui::Image((void*)(intptr_t)DepthMapID, ImVec2(512, 512), ImVec2(0.0f, 1.0f), ImVec2(1.0f, 0.0f)); // 趨ʾС
-                ImGui::End();
-            }
-            {
-                ImGui::Begin("Frame Buffer Texture");
-                ImGui::Image((void*)(intptr_t)fbo.GetFBOTexture()[0], ImVec2(512, 288), ImVec2(0.0f, 1.0f), ImVec2(1.0f, 0.0f)); // 趨ʾС
-                ImGui::End();
-            }
-            ImGui::Render();
-            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-            if (io.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
-            {
-                GLFWwindow* backup_current_context = glfwGetCurrentContext();
-                ImGui::UpdatePlatformWindows();
-                ImGui::RenderPlatformWindowsDefault();
-                glfwMakeContextCurrent(backup_current_context);
             }
 
+            frameTimings.EndFrame();
+            frameIndex++;
+            Trace::End("Frame");
+
             /* Swap front and back buffers */
-            glfwSwapBuffers(window);
+            if (!options.headless)
+                glfwSwapBuffers(window);
 
             /* Poll for and process events */
             glfwPollEvents();
         }
-        ImGui_ImplOpenGL3_Shutdown();
-        ImGui_ImplGlfw_Shutdown();
-        ImGui::DestroyContext();
+        frameTimings.Close();
+        frameCapture.Flush();
+        if (!options.tracePath.empty())
+            Trace::Dump(options.tracePath);
+        if (capturing)
+            std::cout << "Captured " << frameCapture.GetWrittenCount() << " frames to " << options.captureDirectory << std::endl;
+        if (!options.recordPath.empty() && cameraPath.Save(options.recordPath))
+            std::cout << "Recorded " << cameraPath.GetPoseCount() << " camera poses to " << options.recordPath << std::endl;
+        if (!options.headless)
+        {
+            ImGui_ImplOpenGL3_Shutdown();
+            ImGui_ImplGlfw_Shutdown();
+            ImGui::DestroyContext();
+        }
     // Destructor need to be called AFTER vbo/ibo is deleted (fixed)
     }
     glfwTerminate();